@@ -0,0 +1,362 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "agent.h"
+
+#define DEPOSIT_SCORE 100
+#define DRAW_SCORE 5
+#define GAMESTACK_SCORE 8
+#define NEXT_SCORE 3
+#define UNCOVER_SCORE 60
+#define BURIED_PENALTY 4
+#define REPEAT_PENALTY 1000
+#define WIN_SCORE (INT_MAX / TWO)
+
+static void nextDepositCards(const Board* board, int next_card[]);
+
+static const AgentSpec agents[] =
+{
+  { "random", randomAgent, sizeof(AgentContext), resetAgentContext },
+  { "greedy", greedyAgent, sizeof(AgentContext), resetAgentContext },
+  { "lookahead", lookaheadAgent, sizeof(AgentContext), resetAgentContext }
+};
+
+//-----------------------------------------------------------------------------
+///
+/// Looks up a reference agent by name
+///
+/// @param name name of the agent, not necessarily zero terminated
+/// @param length length of the name
+///
+/// @return the agent or NULL if there is no agent with this name
+//
+const AgentSpec* findAgent(const char* name, int length)
+{
+  for (size_t index = 0; index < sizeof(agents) / sizeof(agents[0]); index++)
+  {
+    if ((int)strlen(agents[index].name_) == length &&
+      strncmp(agents[index].name_, name, length) == 0)
+    {
+      return &agents[index];
+    }
+  }
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Lets an agent play a deal until it is won, no move is left or max_moves
+/// moves have been made. The context must have been reset for this game.
+///
+/// @param agent agent to play
+/// @param context per game state of the agent
+/// @param deal board to start from
+/// @param max_moves maximum number of moves
+///
+/// @return result of the game
+//
+GameOutcome playAgentGame(const AgentSpec* agent, void* context,
+  const Board* deal, int max_moves)
+{
+  GameOutcome outcome = { false, false, 0 };
+  Board board = *deal;
+  Move moves[MAX_MOVES];
+
+  while (outcome.moves_ < max_moves && !isWon(&board))
+  {
+    int count = generateMoves(&board, moves);
+    if (count == 0)
+    {
+      break;
+    }
+    Move move = agent->choose_(&board, moves, count, context);
+    int index = 0;
+    while (index < count && (moves[index].card_ != move.card_ ||
+      moves[index].target_stack_ != move.target_stack_))
+    {
+      index++;
+    }
+    if (index == count)
+    {
+      outcome.illegal_move_ = true;
+      break;
+    }
+    applyMove(&board, move);
+    outcome.moves_++;
+  }
+  outcome.won_ = isWon(&board);
+  return outcome;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Resets the context of a reference agent for a new game
+///
+/// @param context AgentContext to reset
+/// @param seed seed for the random choices
+/// @param depth search depth of the lookahead agent
+///
+//
+void resetAgentContext(void* context, unsigned long long seed, int depth)
+{
+  AgentContext* agent_context = (AgentContext*) context;
+  agent_context->random_ = seed;
+  agent_context->depth_ = depth;
+  memset(agent_context->history_, 0, sizeof(agent_context->history_));
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Checks if a board was seen in this game
+///
+/// @param context AgentContext of the game
+/// @param hash hash of the board
+///
+/// @return boolean data type true or false
+//
+static bool seenBoard(const AgentContext* context, unsigned long long hash)
+{
+  return context->history_[hash & (AGENT_HISTORY_SIZE - 1)] == hash;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Remembers a board, an older board with the same slot is forgotten
+///
+/// @param context AgentContext of the game
+/// @param board board to remember
+///
+//
+static void rememberBoard(AgentContext* context, const Board* board)
+{
+  unsigned long long hash = canonicalHash(board);
+  context->history_[hash & (AGENT_HISTORY_SIZE - 1)] = hash;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Picks the move with the highest score, ties are broken randomly
+///
+/// @param context AgentContext of the game
+/// @param moves legal moves
+/// @param scores score of every move
+/// @param move_count number of moves
+///
+/// @return the chosen move
+//
+static Move bestMove(AgentContext* context, const Move moves[],
+  const int scores[], int move_count)
+{
+  int best = 0;
+  int ties = 1;
+  for (int index = 1; index < move_count; index++)
+  {
+    if (scores[index] > scores[best])
+    {
+      best = index;
+      ties = 1;
+    }
+    else if (scores[index] == scores[best] &&
+      randomNumber(&context->random_) % ++ties == 0)
+    {
+      best = index;
+    }
+  }
+  return moves[best];
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Plays a uniformly random legal move
+///
+//
+Move randomAgent(const Board* board, const Move moves[], int move_count,
+  void* context)
+{
+  (void)board;
+  AgentContext* agent_context = (AgentContext*) context;
+  return moves[randomNumber(&agent_context->random_) % move_count];
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Deposits whenever possible and otherwise uncovers the next cards for the
+/// deposit stacks. Without such a move it moves between game stacks, then
+/// plays from the draw stack and rotates the draw stack last, since every
+/// rotation only changes the face up card. Moves back to a board seen
+/// before are avoided.
+///
+//
+Move greedyAgent(const Board* board, const Move moves[], int move_count,
+  void* context)
+{
+  AgentContext* agent_context = (AgentContext*) context;
+  int scores[MAX_MOVES];
+  int next_card[NUMBER_OF_CARDFACES];
+  int top = board->size_[DRAWSTACK] == 0 ? -1 :
+    board->cards_[DRAWSTACK][board->size_[DRAWSTACK] - 1];
+
+  nextDepositCards(board, next_card);
+  rememberBoard(agent_context, board);
+  for (int index = 0; index < move_count; index++)
+  {
+    Move move = moves[index];
+    Board child = *board;
+    applyMove(&child, move);
+    if (move.target_stack_ > NUMBER_OF_GAMESTACKS)
+    {
+      scores[index] = DEPOSIT_SCORE;
+    }
+    else if (move.target_stack_ == DRAWSTACK)
+    {
+      scores[index] = NEXT_SCORE;
+    }
+    else if (move.card_ == top)
+    {
+      scores[index] = DRAW_SCORE;
+    }
+    else
+    {
+      // The card below the moved cards is now the tail of the stack that
+      // got smaller, the target stack grew
+      int source = 1;
+      while (child.size_[source] >= board->size_[source])
+      {
+        source++;
+      }
+      int size = child.size_[source];
+      int uncovered = size == 0 ? -1 : child.cards_[source][size - 1];
+      scores[index] = uncovered >= 0 &&
+        uncovered == next_card[uncovered % TWO] ? UNCOVER_SCORE :
+        GAMESTACK_SCORE;
+    }
+    if (seenBoard(agent_context, canonicalHash(&child)))
+    {
+      scores[index] -= REPEAT_PENALTY;
+    }
+  }
+  return bestMove(agent_context, moves, scores, move_count);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Finds the card each deposit stack needs next, one per color
+///
+/// @param board board to check
+/// @param next_card array to store the card needed for black and red
+///
+//
+static void nextDepositCards(const Board* board, int next_card[])
+{
+  next_card[0] = 0; // BA
+  next_card[1] = 1; // RA
+  for (int stack = DEPOSIT_STACK_1; stack <= DEPOSIT_STACK_2; stack++)
+  {
+    int size = board->size_[stack];
+    if (size != 0)
+    {
+      int top = board->cards_[stack][size - 1];
+      next_card[top % TWO] = top + TWO;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Rates a board by the deposited cards minus the cards lying on top of the
+/// next cards needed on the deposit stacks
+///
+/// @param board board to rate
+///
+/// @return score of the board
+//
+static int evaluateBoard(const Board* board)
+{
+  int next_card[NUMBER_OF_CARDFACES];
+  int score = DEPOSIT_SCORE * (board->size_[DEPOSIT_STACK_1] +
+    board->size_[DEPOSIT_STACK_2]);
+
+  nextDepositCards(board, next_card);
+  for (int stack = 0; stack <= NUMBER_OF_GAMESTACKS; stack++)
+  {
+    int size = board->size_[stack];
+    for (int index = 0; index < size; index++)
+    {
+      int card = board->cards_[stack][index];
+      if (card == next_card[card % TWO])
+      {
+        score -= (size - 1 - index) *
+          (stack == DRAWSTACK ? 1 : BURIED_PENALTY);
+      }
+    }
+  }
+  return score;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Best score reachable within depth moves
+///
+/// @param board board to search from
+/// @param depth number of moves to look ahead
+///
+/// @return best score
+//
+static int lookahead(const Board* board, int depth)
+{
+  if (isWon(board))
+  {
+    return WIN_SCORE;
+  }
+  int best = evaluateBoard(board);
+  if (depth == 0)
+  {
+    return best;
+  }
+  Move moves[MAX_MOVES];
+  int count = generateMoves(board, moves);
+  for (int index = 0; index < count; index++)
+  {
+    Board child = *board;
+    applyMove(&child, moves[index]);
+    int score = lookahead(&child, depth - 1);
+    if (score > best)
+    {
+      best = score;
+    }
+  }
+  return best;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Plays the move with the best score after searching depth moves ahead.
+/// Moves back to a board seen before are avoided.
+///
+//
+Move lookaheadAgent(const Board* board, const Move moves[], int move_count,
+  void* context)
+{
+  AgentContext* agent_context = (AgentContext*) context;
+  int scores[MAX_MOVES];
+  int depth = agent_context->depth_ > 0 ? agent_context->depth_ : 1;
+
+  rememberBoard(agent_context, board);
+  for (int index = 0; index < move_count; index++)
+  {
+    Board child = *board;
+    applyMove(&child, moves[index]);
+    scores[index] = lookahead(&child, depth - 1);
+    if (seenBoard(agent_context, canonicalHash(&child)))
+    {
+      scores[index] -= REPEAT_PENALTY;
+    }
+  }
+  return bestMove(agent_context, moves, scores, move_count);
+}
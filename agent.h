@@ -0,0 +1,55 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#ifndef AGENT_H
+#define AGENT_H
+
+#include "solver.h"
+
+#define DEFAULT_MAX_GAME_MOVES 1000
+#define DEFAULT_LOOKAHEAD_DEPTH 2
+#define AGENT_HISTORY_SIZE 1024
+
+// Called once per turn with the current board and all legal moves. Must
+// return one of the moves. context is the per game state of the agent.
+typedef Move (*Agent)(const Board* board, const Move moves[], int move_count,
+  void* context);
+
+typedef struct _AgentSpec_
+{
+  const char* name_;
+  Agent choose_;
+  size_t context_size_;
+  void (*reset_)(void* context, unsigned long long seed, int depth);
+} AgentSpec;
+
+// Per game state of the reference agents
+typedef struct _AgentContext_
+{
+  unsigned long long random_;
+  int depth_;
+  unsigned long long history_[AGENT_HISTORY_SIZE];
+} AgentContext;
+
+typedef struct _GameOutcome_
+{
+  bool won_;
+  bool illegal_move_;
+  int moves_;
+} GameOutcome;
+
+const AgentSpec* findAgent(const char* name, int length);
+GameOutcome playAgentGame(const AgentSpec* agent, void* context,
+  const Board* deal, int max_moves);
+
+void resetAgentContext(void* context, unsigned long long seed, int depth);
+Move randomAgent(const Board* board, const Move moves[], int move_count,
+  void* context);
+Move greedyAgent(const Board* board, const Move moves[], int move_count,
+  void* context);
+Move lookaheadAgent(const Board* board, const Move moves[], int move_count,
+  void* context);
+
+#endif // AGENT_H
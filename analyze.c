@@ -0,0 +1,468 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "analyze.h"
+#include "batch.h"
+#include "trace.h"
+#include "util.h"
+
+typedef struct _AnalysisRun_
+{
+  AnalyzeOptions options_;
+  Board* deals_;
+  int deal_count_;
+  DealAnalysis* results_;
+  atomic_int next_deal_;
+  atomic_int error_;
+} AnalysisRun;
+
+static ReturnValue parseAnalyzeOptions(int argc, char* argv[],
+  AnalyzeOptions* options);
+static void* analysisWorker(void* argument);
+static void exploreStates(Analyzer* analyzer, const Board* deal,
+  DealAnalysis* analysis);
+static void solveDeal(Analyzer* analyzer, const Board* deal,
+  DealAnalysis* analysis);
+static void countWinningLines(Analyzer* analyzer, const Board* board,
+  int depth, DealAnalysis* analysis);
+static void writeAnalysis(FILE* file, const AnalysisRun* run);
+
+//-----------------------------------------------------------------------------
+///
+/// Analyzes every deal of a corpus in parallel and writes the statistics as
+/// CSV, one row per deal
+///
+/// @param argc number of arguments
+/// @param argv --analyze FILE [--output CSV] [--depth N] [--budget BOARDS]
+///             [--threads N] [--trace FILE]
+///
+/// @return exit code of the program
+//
+int runAnalysis(int argc, char* argv[])
+{
+  AnalysisRun run;
+  memset(&run, 0, sizeof(AnalysisRun));
+  ReturnValue return_value = parseAnalyzeOptions(argc, argv, &run.options_);
+  if (return_value != EVERYTHING_OK)
+  {
+    return printErrorMessage(return_value);
+  }
+  if (run.options_.trace_path_ != NULL &&
+    (return_value = traceStart(run.options_.trace_path_)) != EVERYTHING_OK)
+  {
+    return printErrorMessage(return_value);
+  }
+  traceThreadName("main");
+
+  return_value = readCorpus(run.options_.corpus_path_, &run.deals_,
+    &run.deal_count_);
+  if (return_value == EVERYTHING_OK)
+  {
+    run.results_ = (DealAnalysis*) calloc(run.deal_count_,
+      sizeof(DealAnalysis));
+    return_value = run.results_ == NULL ? OUT_OF_MEMORY : EVERYTHING_OK;
+  }
+  if (return_value != EVERYTHING_OK)
+  {
+    traceStop();
+    free(run.deals_);
+    return printErrorMessage(return_value);
+  }
+
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  int threads = run.options_.threads_ < run.deal_count_ ?
+    run.options_.threads_ : run.deal_count_;
+  pthread_t* workers = (pthread_t*) malloc(threads * sizeof(pthread_t));
+  int started = 0;
+  for (; workers != NULL && started < threads; started++)
+  {
+    if (pthread_create(&workers[started], NULL, analysisWorker, &run) != 0)
+    {
+      break;
+    }
+  }
+  for (int index = 0; index < started; index++)
+  {
+    pthread_join(workers[index], NULL);
+  }
+  free(workers);
+  double seconds = secondsSince(&start);
+
+  return_value = atomic_load(&run.error_);
+  if (return_value == EVERYTHING_OK && started == 0)
+  {
+    return_value = UNIDENTIFIED_ERROR;
+  }
+  if (return_value == EVERYTHING_OK)
+  {
+    FILE* file = run.options_.output_path_ == NULL ? stdout :
+      fopen(run.options_.output_path_, "w");
+    if (file == NULL)
+    {
+      return_value = INVALID_FILE;
+    }
+    else
+    {
+      unsigned long long write_start = TRACE_BEGIN();
+      writeAnalysis(file, &run);
+      TRACE_END("write results", write_start, "deals", run.deal_count_);
+      if (file != stdout && fclose(file) != 0)
+      {
+        return_value = INVALID_FILE;
+      }
+    }
+  }
+  traceStop();
+  free(run.deals_);
+  free(run.results_);
+  if (return_value != EVERYTHING_OK)
+  {
+    return printErrorMessage(return_value);
+  }
+  if (run.options_.output_path_ != NULL)
+  {
+    printf("analyzed %d deals with %d threads in %.2f s\n", run.deal_count_,
+      started, seconds);
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Reads the command line of an analysis run
+///
+/// @param argc number of arguments
+/// @param argv program arguments
+/// @param options options to fill
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue parseAnalyzeOptions(int argc, char* argv[],
+  AnalyzeOptions* options)
+{
+  long processors = sysconf(_SC_NPROCESSORS_ONLN);
+  memset(options, 0, sizeof(AnalyzeOptions));
+  options->threads_ = processors > 0 ? (int)processors : 1;
+  options->depth_ = DEFAULT_LINE_DEPTH;
+  options->budget_ = DEFAULT_ANALYZE_BUDGET;
+
+  Option known[] = {
+    { "--analyze", OPTION_STRING, &options->corpus_path_ },
+    { "--output", OPTION_STRING, &options->output_path_ },
+    { "--trace", OPTION_STRING, &options->trace_path_ },
+    { "--threads", OPTION_INT, &options->threads_ },
+    { "--depth", OPTION_INT, &options->depth_ },
+    { "--budget", OPTION_INT, &options->budget_ } };
+  if (parseOptions(argc, argv, 1, known, sizeof(known) / sizeof(known[0])) !=
+    EVERYTHING_OK || options->corpus_path_ == NULL ||
+    options->threads_ < 1 || options->depth_ < 1 ||
+    options->depth_ > MAX_LINE_DEPTH || options->budget_ < 1)
+  {
+    return INVALID_ARG_COUNT;
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Takes deals until all are analyzed. The search memory is allocated once
+/// per thread and bounded by the state budget.
+///
+/// @param argument pointer to the AnalysisRun
+///
+/// @return NULL
+//
+static void* analysisWorker(void* argument)
+{
+  AnalysisRun* run = (AnalysisRun*) argument;
+  Analyzer analyzer;
+  ReturnValue return_value = analyzerInit(&analyzer, run->options_.budget_);
+  if (return_value != EVERYTHING_OK)
+  {
+    atomic_store(&run->error_, return_value);
+    analyzerFree(&analyzer);
+    return NULL;
+  }
+  traceThreadName("analyzer");
+
+  int deal;
+  while ((deal = atomic_fetch_add(&run->next_deal_, 1)) < run->deal_count_)
+  {
+    unsigned long long start = TRACE_BEGIN();
+    analyzeDeal(&analyzer, &run->deals_[deal], run->options_.depth_,
+      &run->results_[deal]);
+    TRACE_END("analyze", start, "deal", deal);
+  }
+  analyzerFree(&analyzer);
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Allocates the search memory for searches of up to budget boards
+///
+/// @param analyzer analyzer to initialise
+/// @param budget maximum number of boards per search
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue analyzerInit(Analyzer* analyzer, int budget)
+{
+  memset(analyzer, 0, sizeof(Analyzer));
+  analyzer->budget_ = budget;
+
+  // At most half full, so the sets are never flushed
+  size_t capacity = 1;
+  while (capacity < (size_t)budget * TWO)
+  {
+    capacity *= TWO;
+  }
+  analyzer->stack_ = (Board*) malloc(budget * sizeof(Board));
+  if (analyzer->stack_ == NULL ||
+    visitedInit(&analyzer->visited_, capacity) != EVERYTHING_OK ||
+    visitedInit(&analyzer->lines_, capacity) != EVERYTHING_OK)
+  {
+    return OUT_OF_MEMORY;
+  }
+  return solverInit(&analyzer->solver_, budget);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Frees the search memory
+///
+/// @param analyzer analyzer to free
+///
+//
+void analyzerFree(Analyzer* analyzer)
+{
+  free(analyzer->stack_);
+  analyzer->stack_ = NULL;
+  visitedFree(&analyzer->visited_);
+  visitedFree(&analyzer->lines_);
+  solverFree(&analyzer->solver_);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Collects the search statistics of a deal
+///
+/// @param analyzer search memory of the calling thread
+/// @param deal board after arrangeCards
+/// @param depth number of opening moves of the counted winning lines
+/// @param analysis statistics to fill
+///
+//
+void analyzeDeal(Analyzer* analyzer, const Board* deal, int depth,
+  DealAnalysis* analysis)
+{
+  memset(analysis, 0, sizeof(DealAnalysis));
+
+  // All cards of the draw stack but the top one are face down. The low
+  // ranks among them keep the deposit stacks from growing until they are
+  // rotated up.
+  for (int index = 0; index + 1 < deal->size_[DRAWSTACK]; index++)
+  {
+    if (deal->cards_[DRAWSTACK][index] / TWO < EARLY_RANKS)
+    {
+      analysis->face_down_blockers_++;
+    }
+  }
+
+  exploreStates(analyzer, deal, analysis);
+  solveDeal(analyzer, deal, analysis);
+  visitedClear(&analyzer->lines_);
+  analyzer->line_boards_ = 0;
+  analysis->lines_complete_ = true;
+  countWinningLines(analyzer, deal, depth, analysis);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Visits the boards reachable from the deal depth first until the budget
+/// is used up and counts the legal moves of every visited board
+///
+/// @param analyzer search memory of the calling thread
+/// @param deal board to start from
+/// @param analysis statistics to fill
+///
+//
+static void exploreStates(Analyzer* analyzer, const Board* deal,
+  DealAnalysis* analysis)
+{
+  VisitedSet* visited = &analyzer->visited_;
+  Board* stack = analyzer->stack_;
+  size_t budget = analyzer->budget_;
+  long long expanded = 0;
+  long long branches = 0;
+  Move moves[MAX_MOVES];
+
+  visitedClear(visited);
+  visitedInsert(visited, canonicalHash(deal));
+  analysis->states_complete_ = true;
+  int size = 0;
+  stack[size++] = *deal;
+  while (size > 0)
+  {
+    Board board = stack[--size];
+    int count = generateMoves(&board, moves);
+    expanded++;
+    branches += count;
+    for (int move = 0; move < count; move++)
+    {
+      Board child = board;
+      applyMove(&child, moves[move]);
+      unsigned long long key = canonicalHash(&child);
+      if (visited->count_ >= budget)
+      {
+        // Only unknown boards are missing, known ones are skipped anyway
+        analysis->states_complete_ = analysis->states_complete_ &&
+          visitedContains(visited, key);
+      }
+      else if (visitedInsert(visited, key))
+      {
+        stack[size++] = child;
+      }
+    }
+  }
+
+  analysis->reachable_states_ = visited->count_;
+  analysis->branching_factor_ = (double)branches / expanded;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Solves the deal and counts the single NEXT commands of the winning line
+/// found, a rotation by several cards counts as that many. Like the length,
+/// this describes the line the solver found, not the fewest rotations the
+/// deal needs.
+///
+/// @param analyzer search memory of the calling thread
+/// @param deal board to solve
+/// @param analysis statistics to fill
+///
+//
+static void solveDeal(Analyzer* analyzer, const Board* deal,
+  DealAnalysis* analysis)
+{
+  Solver* solver = &analyzer->solver_;
+  analysis->result_ = SOLVE_UNKNOWN;
+  analysis->solution_length_ = -1;
+  analysis->solution_rotations_ = -1;
+  if (solverStart(solver, deal) != EVERYTHING_OK)
+  {
+    return;
+  }
+  analysis->result_ = solverRun(solver, solver->node_budget_);
+  if (analysis->result_ != SOLVE_WON)
+  {
+    return;
+  }
+  analysis->solution_length_ = solver->depth_ - 1;
+  analysis->solution_rotations_ = 0;
+  for (int level = 0; level < analysis->solution_length_; level++)
+  {
+    const SearchFrame* frame = &solver->frames_[level];
+    Move move = frame->moves_[frame->next_move_ - 1];
+    if (move.target_stack_ == DRAWSTACK)
+    {
+      analysis->solution_rotations_ += move.card_;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Counts the distinct boards after depth opening moves and how many of
+/// them can still be won. Openings that transpose into the same board count
+/// once, openings that win earlier count as won. Every board of the opening
+/// tree is charged to the budget, so a large depth stops early instead of
+/// enumerating all openings.
+///
+/// @param analyzer search memory of the calling thread
+/// @param board board after the moves made so far
+/// @param depth number of opening moves still to make
+/// @param analysis statistics to fill
+///
+//
+static void countWinningLines(Analyzer* analyzer, const Board* board,
+  int depth, DealAnalysis* analysis)
+{
+  if (analyzer->line_boards_ >= analyzer->budget_)
+  {
+    analysis->lines_complete_ = false;
+    return;
+  }
+  analyzer->line_boards_++;
+
+  Move moves[MAX_MOVES];
+  int count = 0;
+  if (depth > 0 && !isWon(board))
+  {
+    count = generateMoves(board, moves);
+  }
+  if (count > 0)
+  {
+    for (int move = 0; move < count; move++)
+    {
+      Board child = *board;
+      applyMove(&child, moves[move]);
+      countWinningLines(analyzer, &child, depth - 1, analysis);
+    }
+    return;
+  }
+
+  if (!visitedInsert(&analyzer->lines_, canonicalHash(board)))
+  {
+    return;
+  }
+  analysis->open_lines_++;
+  Solver* solver = &analyzer->solver_;
+  SolveResult result = solverStart(solver, board) == EVERYTHING_OK ?
+    solverRun(solver, solver->node_budget_) : SOLVE_UNKNOWN;
+  if (result == SOLVE_WON)
+  {
+    analysis->winning_lines_++;
+  }
+  else if (result != SOLVE_LOST)
+  {
+    analysis->lines_complete_ = false;
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Writes one CSV row per deal
+///
+/// @param file file to write to
+/// @param run finished analysis run
+///
+//
+static void writeAnalysis(FILE* file, const AnalysisRun* run)
+{
+  const char* results[] = { "unknown", "lost", "won" };
+  fprintf(file, "deal,result,solution_length,solution_rotations,"
+    "reachable_states,states_complete,branching_factor,winning_lines,"
+    "open_lines,lines_complete,face_down_blockers\n");
+  for (int deal = 0; deal < run->deal_count_; deal++)
+  {
+    const DealAnalysis* analysis = &run->results_[deal];
+    fprintf(file, "%d,%s,%d,%d,%lld,%d,%.3f,%lld,%lld,%d,%d\n", deal,
+      results[analysis->result_ - SOLVE_UNKNOWN], analysis->solution_length_,
+      analysis->solution_rotations_, analysis->reachable_states_,
+      analysis->states_complete_, analysis->branching_factor_,
+      analysis->winning_lines_, analysis->open_lines_,
+      analysis->lines_complete_, analysis->face_down_blockers_);
+  }
+}
@@ -0,0 +1,59 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#ifndef ANALYZE_H
+#define ANALYZE_H
+
+#include "solver.h"
+
+#define DEFAULT_ANALYZE_BUDGET 200000
+#define DEFAULT_LINE_DEPTH 2
+#define MAX_LINE_DEPTH 8
+#define EARLY_RANKS 3
+
+typedef struct _AnalyzeOptions_
+{
+  const char* corpus_path_;
+  const char* output_path_;
+  const char* trace_path_;
+  int threads_;
+  int depth_;
+  int budget_;
+} AnalyzeOptions;
+
+// Search statistics of one deal. Counts that hit the budget are lower
+// bounds and marked as incomplete.
+typedef struct _DealAnalysis_
+{
+  SolveResult result_;
+  int solution_length_;
+  int solution_rotations_;
+  long long reachable_states_;
+  bool states_complete_;
+  double branching_factor_;
+  long long winning_lines_;
+  long long open_lines_;
+  bool lines_complete_;
+  int face_down_blockers_;
+} DealAnalysis;
+
+// Search memory of one analysis thread, reused for every deal
+typedef struct _Analyzer_
+{
+  int budget_;
+  VisitedSet visited_;
+  Board* stack_;
+  VisitedSet lines_;
+  long long line_boards_;
+  Solver solver_;
+} Analyzer;
+
+ReturnValue analyzerInit(Analyzer* analyzer, int budget);
+void analyzerFree(Analyzer* analyzer);
+void analyzeDeal(Analyzer* analyzer, const Board* deal, int depth,
+  DealAnalysis* analysis);
+int runAnalysis(int argc, char* argv[]);
+
+#endif // ANALYZE_H
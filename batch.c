@@ -0,0 +1,851 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "trace.h"
+#include "util.h"
+
+#define CHECKPOINT_MAGIC "SOLITAIRE-CHECKPOINT"
+#define TMP_SUFFIX ".tmp"
+#define NO_DEAL -1
+
+static ReturnValue parseBatchOptions(int argc, char* argv[],
+  BatchOptions* options);
+static ReturnValue loadCorpus(Batch* batch);
+static unsigned long long corpusHash(const Batch* batch);
+static ReturnValue readCheckpoint(Batch* batch);
+static ReturnValue formatCheckpoint(const Batch* batch, char** text,
+  size_t* length);
+static ReturnValue saveCheckpoint(const char* path, const char* text,
+  size_t length);
+static ReturnValue writeCheckpoint(Batch* batch, bool locked);
+static void* batchWorker(void* argument);
+static int nextPendingDeal(Batch* batch);
+static bool workersAcknowledged(const Batch* batch);
+static void printResults(const Batch* batch, double seconds);
+static void freeBatch(Batch* batch);
+
+//-----------------------------------------------------------------------------
+///
+/// Solves every deal of a corpus file with a pool of worker threads. The
+/// completed results and the search stacks of the running deals are
+/// written to a checkpoint file periodically, so a killed run can be
+/// continued with --resume.
+///
+/// @param argc number of arguments
+/// @param argv program arguments
+///
+/// @return exit code of the program
+//
+int runBatch(int argc, char* argv[])
+{
+  Batch batch;
+  memset(&batch, 0, sizeof(Batch));
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  ReturnValue return_value = parseBatchOptions(argc, argv, &batch.options_);
+  if (return_value != EVERYTHING_OK)
+  {
+    return printErrorMessage(return_value);
+  }
+  if (batch.options_.trace_path_ != NULL &&
+    (return_value = traceStart(batch.options_.trace_path_)) != EVERYTHING_OK)
+  {
+    return printErrorMessage(return_value);
+  }
+  traceThreadName("main");
+  if ((return_value = loadCorpus(&batch)) != EVERYTHING_OK)
+  {
+    traceStop();
+    freeBatch(&batch);
+    return printErrorMessage(return_value);
+  }
+  if (batch.options_.tablebase_path_ != NULL && (return_value =
+    tablebaseLoad(&batch.tablebase_, batch.options_.tablebase_path_)) !=
+    EVERYTHING_OK)
+  {
+    traceStop();
+    freeBatch(&batch);
+    return printErrorMessage(return_value);
+  }
+  if (batch.options_.resume_ &&
+    (return_value = readCheckpoint(&batch)) != EVERYTHING_OK)
+  {
+    traceStop();
+    freeBatch(&batch);
+    return printErrorMessage(return_value);
+  }
+
+  pthread_mutex_init(&batch.lock_, NULL);
+  pthread_cond_init(&batch.changed_, NULL);
+  batch.workers_ = (BatchWorker*) calloc(batch.options_.threads_,
+    sizeof(BatchWorker));
+  if (batch.workers_ == NULL)
+  {
+    traceStop();
+    freeBatch(&batch);
+    return printErrorMessage(OUT_OF_MEMORY);
+  }
+  int started = 0;
+  for (; started < batch.options_.threads_; started++)
+  {
+    BatchWorker* worker = &batch.workers_[started];
+    worker->batch_ = &batch;
+    worker->id_ = started + 1;
+    worker->deal_ = NO_DEAL;
+    if (pthread_create(&worker->thread_, NULL, batchWorker, worker) != 0)
+    {
+      break;
+    }
+  }
+
+  pthread_mutex_lock(&batch.lock_);
+  struct timespec last_checkpoint = start;
+  while (batch.finished_ < batch.deal_count_ && batch.error_ == EVERYTHING_OK
+    && started > 0)
+  {
+    if (batch.options_.checkpoint_path_ == NULL)
+    {
+      pthread_cond_wait(&batch.changed_, &batch.lock_);
+      continue;
+    }
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += batch.options_.interval_ -
+      (time_t)secondsSince(&last_checkpoint);
+    pthread_cond_timedwait(&batch.changed_, &batch.lock_, &deadline);
+    if (secondsSince(&last_checkpoint) < batch.options_.interval_)
+    {
+      continue;
+    }
+
+    // Ask the workers for their search stacks and wait until all answered
+    batch.epoch_++;
+    while (!workersAcknowledged(&batch) && batch.error_ == EVERYTHING_OK)
+    {
+      pthread_cond_wait(&batch.changed_, &batch.lock_);
+    }
+    ReturnValue checkpoint_error = writeCheckpoint(&batch, true);
+    if (checkpoint_error != EVERYTHING_OK && batch.error_ == EVERYTHING_OK)
+    {
+      batch.error_ = checkpoint_error;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &last_checkpoint);
+  }
+  if (started == 0)
+  {
+    batch.error_ = UNIDENTIFIED_ERROR;
+  }
+  batch.next_deal_ = batch.deal_count_; // stops the workers after an error
+  pthread_mutex_unlock(&batch.lock_);
+
+  for (int index = 0; index < started; index++)
+  {
+    pthread_join(batch.workers_[index].thread_, NULL);
+  }
+
+  return_value = batch.error_;
+  if (return_value == EVERYTHING_OK && batch.options_.checkpoint_path_ != NULL)
+  {
+    return_value = writeCheckpoint(&batch, false);
+  }
+  if (return_value == EVERYTHING_OK)
+  {
+    unsigned long long print_start = TRACE_BEGIN();
+    printResults(&batch, secondsSince(&start));
+    TRACE_END("print results", print_start, "deals", batch.deal_count_);
+  }
+  traceStop();
+  pthread_cond_destroy(&batch.changed_);
+  pthread_mutex_destroy(&batch.lock_);
+  freeBatch(&batch);
+  return return_value == EVERYTHING_OK ? EVERYTHING_OK :
+    printErrorMessage(return_value);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Reads the command line of a batch or solve run
+///
+/// @param argc number of arguments
+/// @param argv program arguments
+/// @param options options to fill
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue parseBatchOptions(int argc, char* argv[],
+  BatchOptions* options)
+{
+  long processors = sysconf(_SC_NPROCESSORS_ONLN);
+  options->threads_ = processors > 0 ? (int)processors : 1;
+  options->interval_ = DEFAULT_CHECKPOINT_INTERVAL;
+  options->node_budget_ = DEFAULT_NODE_BUDGET;
+
+  const char* solve_path = NULL;
+  Option known[] = {
+    { "--batch", OPTION_STRING, &options->corpus_path_ },
+    { "--solve", OPTION_STRING, &solve_path },
+    { "--checkpoint", OPTION_STRING, &options->checkpoint_path_ },
+    { "--trace", OPTION_STRING, &options->trace_path_ },
+    { "--tablebase", OPTION_STRING, &options->tablebase_path_ },
+    { "--threads", OPTION_INT, &options->threads_ },
+    { "--interval", OPTION_INT, &options->interval_ },
+    { "--budget", OPTION_UNSIGNED, &options->node_budget_ },
+    { "--resume", OPTION_FLAG, &options->resume_ } };
+  if (parseOptions(argc, argv, 1, known, sizeof(known) / sizeof(known[0])) !=
+    EVERYTHING_OK || (solve_path != NULL && options->corpus_path_ != NULL))
+  {
+    return INVALID_ARG_COUNT;
+  }
+  if (solve_path != NULL)
+  {
+    options->corpus_path_ = solve_path;
+    options->print_solution_ = true;
+  }
+
+  if (options->corpus_path_ == NULL || options->threads_ < 1 ||
+    options->interval_ < 1 || options->node_budget_ == 0 ||
+    (options->resume_ && options->checkpoint_path_ == NULL))
+  {
+    return INVALID_ARG_COUNT;
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Reads all deals of a corpus file. A corpus is a sequence of
+/// configurations as read by readConfig. The deals are returned as boards
+/// after arrangeCards.
+///
+/// @param path path of the corpus file
+/// @param deals pointer to store the allocated boards
+/// @param deal_count pointer to store the number of deals
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue readCorpus(const char* path, Board** deals, int* deal_count)
+{
+  FILE* file = fopen(path, "r");
+  *deals = NULL;
+  *deal_count = 0;
+  if (file == NULL)
+  {
+    return INVALID_FILE;
+  }
+
+  int capacity = 0;
+  int character;
+  while (true)
+  {
+    while ((character = fgetc(file)) != EOF && isspace(character))
+    {
+    }
+    if (character == EOF)
+    {
+      break;
+    }
+    ungetc(character, file);
+
+    if (*deal_count == capacity)
+    {
+      capacity = capacity == 0 ? SIZE : capacity * TWO;
+      Board* grown = (Board*) realloc(*deals, capacity * sizeof(Board));
+      if (grown == NULL)
+      {
+        fclose(file);
+        return OUT_OF_MEMORY;
+      }
+      *deals = grown;
+    }
+
+    Doubly_Linked_List stacks[NUMBER_OF_STACKS] = { NULL };
+    unsigned long long start = TRACE_BEGIN();
+    ReturnValue return_value = readDeal(file, &stacks[DRAWSTACK]);
+    if (return_value != EVERYTHING_OK)
+    {
+      deleteStacks(stacks);
+      fclose(file);
+      return return_value;
+    }
+    TRACE_END("readConfig", start, "deal", *deal_count);
+    start = TRACE_BEGIN();
+    arrangeCards(stacks);
+    boardFromStacks(&(*deals)[(*deal_count)++], stacks);
+    deleteStacks(stacks);
+    TRACE_END("arrangeCards", start, "deal", *deal_count - 1);
+  }
+  fclose(file);
+  return *deal_count == 0 ? INVALID_FILE : EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Reads all deals of the corpus file
+///
+/// @param batch batch to fill
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue loadCorpus(Batch* batch)
+{
+  ReturnValue return_value = readCorpus(batch->options_.corpus_path_,
+    &batch->deals_, &batch->deal_count_);
+  if (return_value != EVERYTHING_OK)
+  {
+    return return_value;
+  }
+  batch->results_ = (DealResult*) calloc(batch->deal_count_,
+    sizeof(DealResult));
+  batch->progress_ = (DealProgress*) calloc(batch->deal_count_,
+    sizeof(DealProgress));
+  if (batch->results_ == NULL || batch->progress_ == NULL)
+  {
+    return OUT_OF_MEMORY;
+  }
+  for (int deal = 0; deal < batch->deal_count_; deal++)
+  {
+    batch->results_[deal].result_ = SOLVE_RUNNING;
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Hashes all deals, so a checkpoint is only resumed on the same corpus
+///
+/// @param batch batch with loaded corpus
+///
+/// @return hash of the corpus
+//
+static unsigned long long corpusHash(const Batch* batch)
+{
+  unsigned long long hash = 0;
+  for (int deal = 0; deal < batch->deal_count_; deal++)
+  {
+    hash = hash * 31 + hashBoard(&batch->deals_[deal]);
+  }
+  return hash;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Loads the results and search stacks of a previous run. A missing
+/// checkpoint file starts the run from the beginning.
+///
+/// @param batch batch with loaded corpus
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue readCheckpoint(Batch* batch)
+{
+  FILE* file = fopen(batch->options_.checkpoint_path_, "r");
+  if (file == NULL)
+  {
+    printf("[INFO] No checkpoint found, starting from the beginning\n");
+    return EVERYTHING_OK;
+  }
+  unsigned long long start = TRACE_BEGIN();
+
+  char magic[sizeof(CHECKPOINT_MAGIC)];
+  int version;
+  int deal_count;
+  unsigned long long hash;
+  unsigned long long node_budget;
+  if (fscanf(file, " %20s %d %d %llu %llu", magic, &version, &deal_count,
+    &hash, &node_budget) != 5 || strcmp(magic, CHECKPOINT_MAGIC) != 0 ||
+    version != CHECKPOINT_VERSION || deal_count != batch->deal_count_ ||
+    hash != corpusHash(batch) || node_budget != batch->options_.node_budget_)
+  {
+    fclose(file);
+    return INVALID_CHECKPOINT;
+  }
+
+  char kind[SIZE];
+  int deal;
+  ReturnValue return_value = INVALID_CHECKPOINT;
+  while (fscanf(file, " %19s", kind) == 1)
+  {
+    if (strcmp(kind, "end") == 0)
+    {
+      return_value = EVERYTHING_OK;
+      break;
+    }
+    if (fscanf(file, " %d", &deal) != 1 || deal < 0 || deal >= deal_count)
+    {
+      break;
+    }
+    // A deal is written once, a second record means a damaged file
+    if (strcmp(kind, "done") == 0)
+    {
+      DealResult* result = &batch->results_[deal];
+      int stored_moves;
+      if (result->result_ != SOLVE_RUNNING ||
+        fscanf(file, " %d %d %llu %d", (int*)&result->result_,
+        &result->solution_length_, &result->nodes_, &stored_moves) != 4 ||
+        result->result_ < SOLVE_UNKNOWN || result->result_ > SOLVE_WON ||
+        stored_moves < 0 || stored_moves > result->solution_length_)
+      {
+        break;
+      }
+      if (stored_moves > 0)
+      {
+        result->solution_ = (Move*) malloc(stored_moves * sizeof(Move));
+        if (result->solution_ == NULL)
+        {
+          return_value = OUT_OF_MEMORY;
+          break;
+        }
+      }
+      int card;
+      int target_stack;
+      int read = 0;
+      for (; read < stored_moves; read++)
+      {
+        if (fscanf(file, " %d %d", &card, &target_stack) != 2)
+        {
+          break;
+        }
+        result->solution_[read].card_ = card;
+        result->solution_[read].target_stack_ = target_stack;
+      }
+      if (read != stored_moves)
+      {
+        break;
+      }
+      batch->finished_++;
+    }
+    else if (strcmp(kind, "progress") == 0)
+    {
+      DealProgress* progress = &batch->progress_[deal];
+      if (progress->path_ != NULL ||
+        fscanf(file, " %llu %d", &progress->nodes_, &progress->depth_) != 2
+        || progress->depth_ < 1)
+      {
+        break;
+      }
+      progress->path_ = (int*) malloc(progress->depth_ * sizeof(int));
+      if (progress->path_ == NULL)
+      {
+        return_value = OUT_OF_MEMORY;
+        break;
+      }
+      int level = 0;
+      for (; level < progress->depth_; level++)
+      {
+        if (fscanf(file, " %d", &progress->path_[level]) != 1)
+        {
+          break;
+        }
+      }
+      if (level != progress->depth_)
+      {
+        break;
+      }
+    }
+    else
+    {
+      break;
+    }
+  }
+  fclose(file);
+  TRACE_END("read checkpoint", start, "finished", batch->finished_);
+  return return_value;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Formats all finished results and the search stacks the workers handed in
+/// as checkpoint text. Only memory is touched, so the lock can be held while
+/// the workers' data is copied and released before the disk is written.
+///
+/// @param batch batch to save
+/// @param text pointer to store the allocated text
+/// @param length pointer to store the length of the text
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue formatCheckpoint(const Batch* batch, char** text,
+  size_t* length)
+{
+  FILE* file = open_memstream(text, length);
+  if (file == NULL)
+  {
+    return OUT_OF_MEMORY;
+  }
+
+  fprintf(file, "%s %d %d %llu %llu\n", CHECKPOINT_MAGIC, CHECKPOINT_VERSION,
+    batch->deal_count_, corpusHash(batch), batch->options_.node_budget_);
+  for (int deal = 0; deal < batch->deal_count_; deal++)
+  {
+    const DealResult* result = &batch->results_[deal];
+    if (result->result_ == SOLVE_RUNNING)
+    {
+      continue;
+    }
+    int stored_moves = result->solution_ != NULL ? result->solution_length_ : 0;
+    fprintf(file, "done %d %d %d %llu %d", deal, result->result_,
+      result->solution_length_, result->nodes_, stored_moves);
+    for (int index = 0; index < stored_moves; index++)
+    {
+      fprintf(file, " %d %d", result->solution_[index].card_,
+        result->solution_[index].target_stack_);
+    }
+    fprintf(file, "\n");
+  }
+  for (int index = 0; index < batch->options_.threads_; index++)
+  {
+    const BatchWorker* worker = &batch->workers_[index];
+    if (worker->deal_ == NO_DEAL || worker->snapshot_depth_ == 0 ||
+      worker->snapshot_epoch_ != batch->epoch_)
+    {
+      continue;
+    }
+    fprintf(file, "progress %d %llu %d", worker->deal_,
+      worker->snapshot_nodes_, worker->snapshot_depth_);
+    for (int level = 0; level < worker->snapshot_depth_; level++)
+    {
+      fprintf(file, " %d", worker->snapshot_[level]);
+    }
+    fprintf(file, "\n");
+  }
+  // Resumed stacks of deals no worker has picked up again yet
+  for (int deal = batch->next_deal_; deal < batch->deal_count_; deal++)
+  {
+    const DealProgress* progress = &batch->progress_[deal];
+    if (progress->depth_ == 0 || batch->results_[deal].result_ != SOLVE_RUNNING)
+    {
+      continue;
+    }
+    fprintf(file, "progress %d %llu %d", deal, progress->nodes_,
+      progress->depth_);
+    for (int level = 0; level < progress->depth_; level++)
+    {
+      fprintf(file, " %d", progress->path_[level]);
+    }
+    fprintf(file, "\n");
+  }
+  fprintf(file, "end\n");
+
+  if (ferror(file) != 0)
+  {
+    fclose(file);
+    free(*text);
+    *text = NULL;
+    return OUT_OF_MEMORY;
+  }
+  return fclose(file) == 0 ? EVERYTHING_OK : OUT_OF_MEMORY;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Writes checkpoint text to a temporary file and renames it over the
+/// checkpoint, so a crash during writing keeps the previous checkpoint intact
+///
+/// @param path path of the checkpoint
+/// @param text text made by formatCheckpoint
+/// @param length length of the text
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue saveCheckpoint(const char* path, const char* text,
+  size_t length)
+{
+  unsigned long long start = TRACE_BEGIN();
+  char* tmp_path = (char*) malloc(strlen(path) + sizeof(TMP_SUFFIX));
+  if (tmp_path == NULL)
+  {
+    return OUT_OF_MEMORY;
+  }
+  strcpy(tmp_path, path);
+  strcat(tmp_path, TMP_SUFFIX);
+
+  FILE* file = fopen(tmp_path, "w");
+  if (file == NULL)
+  {
+    free(tmp_path);
+    return INVALID_CHECKPOINT;
+  }
+  bool written = fwrite(text, 1, length, file) == length &&
+    fflush(file) == 0 && fsync(fileno(file)) == 0;
+  written = fclose(file) == 0 && written;
+  written = written && rename(tmp_path, path) == 0;
+  free(tmp_path);
+  TRACE_END("write checkpoint", start, "bytes", (long long)length);
+  return written ? EVERYTHING_OK : INVALID_CHECKPOINT;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Writes a checkpoint of the batch. The workers' data is copied first, so
+/// they are not kept waiting while the file is written and synced.
+///
+/// @param batch batch to save
+/// @param locked true if the caller holds the lock, it is released while the
+///               file is written
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue writeCheckpoint(Batch* batch, bool locked)
+{
+  char* text = NULL;
+  size_t length = 0;
+  ReturnValue return_value = formatCheckpoint(batch, &text, &length);
+  if (return_value != EVERYTHING_OK)
+  {
+    return return_value;
+  }
+  if (locked)
+  {
+    pthread_mutex_unlock(&batch->lock_);
+  }
+  return_value = saveCheckpoint(batch->options_.checkpoint_path_, text,
+    length);
+  if (locked)
+  {
+    pthread_mutex_lock(&batch->lock_);
+  }
+  free(text);
+  return return_value;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Picks the next deal without a result. Must be called with the lock held.
+///
+/// @param batch batch to pick from
+///
+/// @return index of the deal or NO_DEAL if all deals are taken
+//
+static int nextPendingDeal(Batch* batch)
+{
+  while (batch->next_deal_ < batch->deal_count_)
+  {
+    int deal = batch->next_deal_++;
+    if (batch->results_[deal].result_ == SOLVE_RUNNING)
+    {
+      return deal;
+    }
+  }
+  return NO_DEAL;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Checks if every busy worker has handed in its search stack for the
+/// current checkpoint. Must be called with the lock held.
+///
+/// @param batch batch to check
+///
+/// @return boolean data type true or false
+//
+static bool workersAcknowledged(const Batch* batch)
+{
+  for (int index = 0; index < batch->options_.threads_; index++)
+  {
+    const BatchWorker* worker = &batch->workers_[index];
+    if (worker->deal_ != NO_DEAL && worker->snapshot_epoch_ != batch->epoch_)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Solves deals until none is left. Between two chunks of the search the
+/// worker hands in its search stack if a checkpoint was requested.
+///
+/// @param argument pointer to the BatchWorker
+///
+/// @return NULL
+//
+static void* batchWorker(void* argument)
+{
+  BatchWorker* worker = (BatchWorker*) argument;
+  Batch* batch = worker->batch_;
+  Solver solver;
+  Move* solution = NULL;
+  char name[TRACE_THREAD_NAME_SIZE];
+  snprintf(name, TRACE_THREAD_NAME_SIZE, "worker %d", worker->id_);
+  traceThreadName(name);
+  ReturnValue error = solverInit(&solver, batch->options_.node_budget_);
+  solver.tablebase_ = &batch->tablebase_;
+
+  while (error == EVERYTHING_OK)
+  {
+    pthread_mutex_lock(&batch->lock_);
+    int deal = nextPendingDeal(batch);
+    worker->deal_ = deal;
+    pthread_mutex_unlock(&batch->lock_);
+    if (deal == NO_DEAL)
+    {
+      break;
+    }
+
+    const Board* board = &batch->deals_[deal];
+    const DealProgress* progress = &batch->progress_[deal];
+    if (progress->depth_ == 0 || solverRestore(&solver, board,
+      progress->path_, progress->depth_, progress->nodes_) != EVERYTHING_OK)
+    {
+      error = solverStart(&solver, board);
+    }
+
+    SolveResult result = SOLVE_RUNNING;
+    while (result == SOLVE_RUNNING && error == EVERYTHING_OK)
+    {
+      unsigned long long start = TRACE_BEGIN();
+      result = solverRun(&solver, SEARCH_CHUNK_NODES);
+      TRACE_END("search", start, "deal", deal);
+      if (result == SOLVE_WON && batch->options_.print_solution_)
+      {
+        solution = (Move*) malloc(solver.depth_ * sizeof(Move));
+        if (solution == NULL)
+        {
+          error = OUT_OF_MEMORY;
+          break;
+        }
+        solverSolution(&solver, solution, solver.depth_);
+      }
+
+      pthread_mutex_lock(&batch->lock_);
+      if (result == SOLVE_RUNNING && worker->snapshot_epoch_ != batch->epoch_)
+      {
+        if (worker->snapshot_capacity_ < solver.depth_)
+        {
+          int* snapshot = (int*) realloc(worker->snapshot_,
+            solver.capacity_ * sizeof(int));
+          if (snapshot == NULL)
+          {
+            error = OUT_OF_MEMORY;
+          }
+          else
+          {
+            worker->snapshot_ = snapshot;
+            worker->snapshot_capacity_ = solver.capacity_;
+          }
+        }
+        if (error == EVERYTHING_OK)
+        {
+          worker->snapshot_depth_ = solverProgress(&solver, worker->snapshot_,
+            worker->snapshot_capacity_);
+          worker->snapshot_nodes_ = solver.nodes_;
+          worker->snapshot_epoch_ = batch->epoch_;
+        }
+      }
+      if (result != SOLVE_RUNNING)
+      {
+        DealResult* deal_result = &batch->results_[deal];
+        deal_result->result_ = result;
+        deal_result->solution_length_ = result == SOLVE_WON ?
+          solver.depth_ - 1 : 0;
+        deal_result->nodes_ = solver.nodes_;
+        deal_result->solution_ = solution;
+        solution = NULL;
+        worker->deal_ = NO_DEAL;
+        worker->snapshot_depth_ = 0;
+        batch->finished_++;
+      }
+      pthread_cond_broadcast(&batch->changed_);
+      pthread_mutex_unlock(&batch->lock_);
+    }
+  }
+
+  pthread_mutex_lock(&batch->lock_);
+  worker->deal_ = NO_DEAL;
+  if (error != EVERYTHING_OK)
+  {
+    batch->error_ = error;
+  }
+  pthread_cond_broadcast(&batch->changed_);
+  pthread_mutex_unlock(&batch->lock_);
+  solverFree(&solver);
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Prints one line per deal and a summary
+///
+/// @param batch finished batch
+/// @param seconds run time of the batch
+///
+//
+static void printResults(const Batch* batch, double seconds)
+{
+  int count[3] = { 0 };
+  unsigned long long nodes = 0;
+
+  for (int deal = 0; deal < batch->deal_count_; deal++)
+  {
+    const DealResult* result = &batch->results_[deal];
+    nodes += result->nodes_;
+    switch (result->result_)
+    {
+    case SOLVE_WON:
+      count[0]++;
+      printf("deal %d: won in %d moves (%llu boards)\n", deal,
+        result->solution_length_, result->nodes_);
+      for (int index = 0; result->solution_ != NULL &&
+        index < result->solution_length_; index++)
+      {
+        printMove(result->solution_[index]);
+      }
+      break;
+    case SOLVE_LOST:
+      count[1]++;
+      printf("deal %d: lost (%llu boards)\n", deal, result->nodes_);
+      break;
+    default:
+      count[2]++;
+      printf("deal %d: unknown, budget exhausted (%llu boards)\n", deal,
+        result->nodes_);
+      break;
+    }
+  }
+  printf("won %d, lost %d, unknown %d of %d deals, %llu boards in %.2f s\n",
+    count[0], count[1], count[2], batch->deal_count_, nodes, seconds);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Frees all memory of a batch
+///
+/// @param batch batch to free
+///
+//
+static void freeBatch(Batch* batch)
+{
+  for (int deal = 0; batch->results_ != NULL && deal < batch->deal_count_;
+    deal++)
+  {
+    free(batch->results_[deal].solution_);
+  }
+  for (int deal = 0; batch->progress_ != NULL && deal < batch->deal_count_;
+    deal++)
+  {
+    free(batch->progress_[deal].path_);
+  }
+  for (int index = 0; batch->workers_ != NULL &&
+    index < batch->options_.threads_; index++)
+  {
+    free(batch->workers_[index].snapshot_);
+  }
+  free(batch->workers_);
+  free(batch->results_);
+  free(batch->progress_);
+  free(batch->deals_);
+  tablebaseFree(&batch->tablebase_);
+  memset(batch, 0, sizeof(Batch));
+}
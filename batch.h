@@ -0,0 +1,83 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <pthread.h>
+
+#include "solver.h"
+#include "tablebase.h"
+
+#define DEFAULT_NODE_BUDGET 2000000ULL
+#define DEFAULT_CHECKPOINT_INTERVAL 60
+#define SEARCH_CHUNK_NODES 65536ULL
+#define CHECKPOINT_VERSION 2
+
+typedef struct _BatchOptions_
+{
+  const char* corpus_path_;
+  const char* checkpoint_path_;
+  const char* trace_path_;
+  const char* tablebase_path_;
+  bool resume_;
+  bool print_solution_;
+  int threads_;
+  int interval_;
+  unsigned long long node_budget_;
+} BatchOptions;
+
+typedef struct _DealResult_
+{
+  SolveResult result_;
+  int solution_length_;
+  unsigned long long nodes_;
+  Move* solution_;
+} DealResult;
+
+// Search stack of a deal that was in progress when a checkpoint was written
+typedef struct _DealProgress_
+{
+  int* path_;
+  int depth_;
+  unsigned long long nodes_;
+} DealProgress;
+
+struct _Batch_;
+
+typedef struct _BatchWorker_
+{
+  pthread_t thread_;
+  struct _Batch_* batch_;
+  int id_;
+  int deal_;
+  unsigned long long snapshot_epoch_;
+  int* snapshot_;
+  int snapshot_depth_;
+  int snapshot_capacity_;
+  unsigned long long snapshot_nodes_;
+} BatchWorker;
+
+typedef struct _Batch_
+{
+  BatchOptions options_;
+  Tablebase tablebase_;
+  Board* deals_;
+  int deal_count_;
+  DealResult* results_;
+  DealProgress* progress_;
+  int next_deal_;
+  int finished_;
+  unsigned long long epoch_;
+  ReturnValue error_;
+  pthread_mutex_t lock_;
+  pthread_cond_t changed_;
+  BatchWorker* workers_;
+} Batch;
+
+ReturnValue readCorpus(const char* path, Board** deals, int* deal_count);
+int runBatch(int argc, char* argv[]);
+
+#endif // BATCH_H
@@ -0,0 +1,243 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "evaluate.h"
+#include "trace.h"
+#include "util.h"
+
+#define AGENT_SEED_MIX 0x5DEECE66DULL
+
+typedef struct _EvaluationWorker_
+{
+  pthread_t thread_;
+  const AgentSpec* agent_;
+  const EvaluationOptions* options_;
+  atomic_llong* next_game_;
+  EvaluationResult result_;
+  ReturnValue error_;
+} EvaluationWorker;
+
+static void* evaluationWorker(void* argument);
+
+//-----------------------------------------------------------------------------
+///
+/// Plays an agent over options->games_ seeded deals with a pool of threads
+///
+/// @param agent agent to evaluate
+/// @param options number of games, seed, threads and limits
+/// @param result sums over all games
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue evaluateAgent(const AgentSpec* agent,
+  const EvaluationOptions* options, EvaluationResult* result)
+{
+  atomic_llong next_game = 0;
+  struct timespec start;
+  struct timespec end;
+  EvaluationWorker* workers = (EvaluationWorker*) calloc(options->threads_,
+    sizeof(EvaluationWorker));
+  if (workers == NULL)
+  {
+    return OUT_OF_MEMORY;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  int started = 0;
+  for (; started < options->threads_; started++)
+  {
+    workers[started].agent_ = agent;
+    workers[started].options_ = options;
+    workers[started].next_game_ = &next_game;
+    if (pthread_create(&workers[started].thread_, NULL, evaluationWorker,
+      &workers[started]) != 0)
+    {
+      break;
+    }
+  }
+
+  ReturnValue return_value = started == 0 ? UNIDENTIFIED_ERROR : EVERYTHING_OK;
+  memset(result, 0, sizeof(EvaluationResult));
+  for (int index = 0; index < started; index++)
+  {
+    EvaluationWorker* worker = &workers[index];
+    pthread_join(worker->thread_, NULL);
+    result->games_ += worker->result_.games_;
+    result->won_ += worker->result_.won_;
+    result->illegal_ += worker->result_.illegal_;
+    result->moves_ += worker->result_.moves_;
+    result->won_moves_ += worker->result_.won_moves_;
+    if (worker->error_ != EVERYTHING_OK)
+    {
+      return_value = worker->error_;
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  result->seconds_ = (end.tv_sec - start.tv_sec) +
+    (end.tv_nsec - start.tv_nsec) / 1e9;
+  free(workers);
+  return return_value;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Plays chunks of games until all games are taken
+///
+/// @param argument pointer to the EvaluationWorker
+///
+/// @return NULL
+//
+static void* evaluationWorker(void* argument)
+{
+  EvaluationWorker* worker = (EvaluationWorker*) argument;
+  const EvaluationOptions* options = worker->options_;
+  void* context = malloc(worker->agent_->context_size_);
+  int cards[NUMBER_OF_CARDS];
+  Board deal;
+
+  if (context == NULL)
+  {
+    worker->error_ = OUT_OF_MEMORY;
+    return NULL;
+  }
+  while (true)
+  {
+    long long first = atomic_fetch_add(worker->next_game_,
+      EVALUATION_CHUNK_GAMES);
+    if (first >= options->games_)
+    {
+      break;
+    }
+    long long last = first + EVALUATION_CHUNK_GAMES;
+    if (last > options->games_)
+    {
+      last = options->games_;
+    }
+
+    unsigned long long start = TRACE_BEGIN();
+    for (long long game = first; game < last; game++)
+    {
+      unsigned long long seed = dealSeed(options->seed_, game);
+      shuffleDeal(seed, cards);
+      boardFromDeal(&deal, cards);
+      worker->agent_->reset_(context, seed ^ AGENT_SEED_MIX, options->depth_);
+      GameOutcome outcome = playAgentGame(worker->agent_, context, &deal,
+        options->max_moves_);
+
+      worker->result_.games_++;
+      worker->result_.moves_ += outcome.moves_;
+      if (outcome.won_)
+      {
+        worker->result_.won_++;
+        worker->result_.won_moves_ += outcome.moves_;
+      }
+      if (outcome.illegal_move_)
+      {
+        worker->result_.illegal_++;
+      }
+    }
+    TRACE_END("games", start, "first", first);
+  }
+  free(context);
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Evaluates one or more agents from the command line
+///
+/// @param argc number of arguments
+/// @param argv --evaluate AGENT[,AGENT...] [--games N] [--seed N]
+///             [--threads N] [--max-moves N] [--depth N] [--trace FILE]
+///
+/// @return exit code of the program
+//
+int runEvaluation(int argc, char* argv[])
+{
+  EvaluationOptions options;
+  long processors = sysconf(_SC_NPROCESSORS_ONLN);
+  const char* names = NULL;
+  const char* trace_path = NULL;
+  options.games_ = DEFAULT_EVALUATION_GAMES;
+  options.seed_ = 1;
+  options.threads_ = processors > 0 ? (int)processors : 1;
+  options.max_moves_ = DEFAULT_MAX_GAME_MOVES;
+  options.depth_ = DEFAULT_LOOKAHEAD_DEPTH;
+
+  Option known[] = {
+    { "--evaluate", OPTION_STRING, &names },
+    { "--games", OPTION_LONG_LONG, &options.games_ },
+    { "--seed", OPTION_UNSIGNED, &options.seed_ },
+    { "--threads", OPTION_INT, &options.threads_ },
+    { "--max-moves", OPTION_INT, &options.max_moves_ },
+    { "--depth", OPTION_INT, &options.depth_ },
+    { "--trace", OPTION_STRING, &trace_path } };
+  if (parseOptions(argc, argv, 1, known, sizeof(known) / sizeof(known[0])) !=
+    EVERYTHING_OK || names == NULL || options.games_ < 1 ||
+    options.threads_ < 1 || options.max_moves_ < 1 || options.depth_ < 1)
+  {
+    return printErrorMessage(INVALID_ARG_COUNT);
+  }
+
+  // Check all names first, so a typo does not show up after a long run
+  for (const char* name = names; ; name++)
+  {
+    const char* end = strchr(name, ',');
+    int length = end == NULL ? (int)strlen(name) : (int)(end - name);
+    if (findAgent(name, length) == NULL)
+    {
+      printf("[ERR] Unknown agent %.*s, use random, greedy or lookahead\n",
+        length, name);
+      return 1;
+    }
+    if (end == NULL)
+    {
+      break;
+    }
+    name = end;
+  }
+
+  ReturnValue return_value;
+  if (trace_path != NULL &&
+    (return_value = traceStart(trace_path)) != EVERYTHING_OK)
+  {
+    return printErrorMessage(return_value);
+  }
+  return_value = EVERYTHING_OK;
+  for (const char* name = names; return_value == EVERYTHING_OK; name++)
+  {
+    const char* end = strchr(name, ',');
+    int length = end == NULL ? (int)strlen(name) : (int)(end - name);
+    const AgentSpec* agent = findAgent(name, length);
+    EvaluationResult result;
+    return_value = evaluateAgent(agent, &options, &result);
+    if (return_value == EVERYTHING_OK)
+    {
+      printf("agent %s: %lld games, won %lld (%.2f%%), %.1f moves per game, "
+        "%.1f moves per won game, %lld illegal, %.0f moves/s, %.2f s\n",
+        agent->name_, result.games_, result.won_,
+        100.0 * result.won_ / result.games_,
+        (double)result.moves_ / result.games_,
+        result.won_ == 0 ? 0.0 : (double)result.won_moves_ / result.won_,
+        result.illegal_, result.moves_ / result.seconds_, result.seconds_);
+    }
+    if (end == NULL)
+    {
+      break;
+    }
+    name = end;
+  }
+  traceStop();
+  return return_value == EVERYTHING_OK ? EVERYTHING_OK :
+    printErrorMessage(return_value);
+}
@@ -0,0 +1,37 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include "agent.h"
+
+#define DEFAULT_EVALUATION_GAMES 10000LL
+#define EVALUATION_CHUNK_GAMES 256LL
+
+typedef struct _EvaluationOptions_
+{
+  long long games_;
+  unsigned long long seed_;
+  int threads_;
+  int max_moves_;
+  int depth_;
+} EvaluationOptions;
+
+typedef struct _EvaluationResult_
+{
+  long long games_;
+  long long won_;
+  long long illegal_;
+  long long moves_;
+  long long won_moves_;
+  double seconds_;
+} EvaluationResult;
+
+ReturnValue evaluateAgent(const AgentSpec* agent,
+  const EvaluationOptions* options, EvaluationResult* result);
+int runEvaluation(int argc, char* argv[]);
+
+#endif // EVALUATE_H
@@ -0,0 +1,225 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "game.h"
+
+struct _Game_
+{
+  Doubly_Linked_List stacks_[NUMBER_OF_STACKS];
+};
+
+//-----------------------------------------------------------------------------
+///
+/// Creates a game without cards
+///
+/// @param game pointer to store the handle
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue gameCreate(Game** game)
+{
+  *game = (Game*) calloc(1, sizeof(Game));
+  return *game == NULL ? OUT_OF_MEMORY : EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Frees a game and all of its cards
+///
+/// @param game handle of the game, may be NULL
+///
+//
+void gameDestroy(Game* game)
+{
+  if (game != NULL)
+  {
+    deleteStacks(game->stacks_);
+    free(game);
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Deals a configuration given as text in the format of config.txt. The
+/// cards of a previous deal are removed.
+///
+/// @param game handle of the game
+/// @param text the configuration, does not need to be zero terminated
+/// @param length length of the text
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue gameLoadConfig(Game* game, const char* text, size_t length)
+{
+  deleteStacks(game->stacks_);
+  FILE* file = length == 0 ? NULL : fmemopen((void*)text, length, "r");
+  if (file == NULL)
+  {
+    return INVALID_FILE;
+  }
+  ReturnValue return_value = readConfig(file, &game->stacks_[DRAWSTACK]);
+  fclose(file);
+  if (return_value != EVERYTHING_OK)
+  {
+    deleteStacks(game->stacks_);
+    return return_value;
+  }
+  arrangeCards(game->stacks_);
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Deals NUMBER_OF_CARDS cards given in the order of a configuration. The
+/// cards of a previous deal are removed, every card has to appear once.
+///
+/// @param game handle of the game
+/// @param cards card values, rank * 2 plus 1 for red
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue gameLoadCards(Game* game, const int cards[])
+{
+  bool dealt[NUMBER_OF_CARDS] = { false };
+  deleteStacks(game->stacks_);
+  for (int index = 0; index < NUMBER_OF_CARDS; index++)
+  {
+    if (cards[index] < 0 || NUMBER_OF_CARDS <= cards[index])
+    {
+      return INVALID_CARD;
+    }
+    if (dealt[cards[index]])
+    {
+      return DUPLICATE_CARD;
+    }
+    dealt[cards[index]] = true;
+  }
+  for (int index = 0; index < NUMBER_OF_CARDS; index++)
+  {
+    if (append(&game->stacks_[DRAWSTACK], cards[index], true) !=
+      EVERYTHING_OK)
+    {
+      deleteStacks(game->stacks_);
+      return OUT_OF_MEMORY;
+    }
+  }
+  arrangeCards(game->stacks_);
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Moves a face up card and all cards on top of it, like the MOVE command
+///
+/// @param game handle of the game
+/// @param card card to move
+/// @param target_stack stack to move the card to
+///
+/// @return MOVED or a value to evaluate the occurrence of an error
+//
+ReturnValue gameMove(Game* game, int card, int target_stack)
+{
+  return moveCard(game->stacks_, card, target_stack);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Turns the next card of the draw stack, like the NEXT command
+///
+/// @param game handle of the game
+///
+/// @return MOVED
+//
+ReturnValue gameNext(Game* game)
+{
+  rotateDrawstack(&game->stacks_[DRAWSTACK], 1);
+  return MOVED;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Checks if the game is won
+///
+/// @param game handle of the game
+///
+/// @return boolean data type true or false
+//
+bool gameIsWon(const Game* game)
+{
+  return isGameWon((Doubly_Linked_List*)game->stacks_);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Counts the cards of a stack
+///
+/// @param game handle of the game
+/// @param stack number of the stack, 0 is the draw stack
+///
+/// @return number of cards, 0 for an invalid stack
+//
+int gameStackSize(const Game* game, int stack)
+{
+  int size = 0;
+  if (stack < 0 || NUMBER_OF_STACKS <= stack)
+  {
+    return 0;
+  }
+  for (Node* node = game->stacks_[stack].head_; node != NULL;
+    node = node->next_)
+  {
+    size++;
+  }
+  return size;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Reads a card of the board
+///
+/// @param game handle of the game
+/// @param stack number of the stack, 0 is the draw stack
+/// @param index position in the stack, 0 is the bottom card
+/// @param card pointer to store the card value or FACE_DOWN_CARD
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue gameCard(const Game* game, int stack, int index, int* card)
+{
+  if (stack < 0 || NUMBER_OF_STACKS <= stack || index < 0)
+  {
+    return INVALID_CARD;
+  }
+  Node* node = game->stacks_[stack].head_;
+  for (; node != NULL && index > 0; index--)
+  {
+    node = node->next_;
+  }
+  if (node == NULL)
+  {
+    return INVALID_CARD;
+  }
+  *card = node->is_faced_up_ ? node->card_value_ : FACE_DOWN_CARD;
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Converts a color and a rank as written in commands into a card value
+///
+/// @param color BLACK or RED
+/// @param rank A, 2 to 10, J, Q or K
+/// @param card pointer to store the card value
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue gameParseCard(const char* color, const char* rank, int* card)
+{
+  return strToCard((char*)color, (char*)rank, card);
+}
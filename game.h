@@ -0,0 +1,40 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+// Embeddable game engine (libsolitaire). Every game lives in its own handle,
+// nothing is printed and no state is shared between handles, so any number
+// of games can be played on any threads as long as one handle is only used
+// by one thread at a time.
+//
+#ifndef GAME_H
+#define GAME_H
+
+#include <stddef.h>
+
+#include "solitaire.h"
+
+#define FACE_DOWN_CARD -1
+
+// The shared library is built with -fvisibility=hidden, only this API is
+// exported
+#define GAME_API __attribute__((visibility("default")))
+
+typedef struct _Game_ Game;
+
+GAME_API ReturnValue gameCreate(Game** game);
+GAME_API void gameDestroy(Game* game);
+GAME_API ReturnValue gameLoadConfig(Game* game, const char* text,
+  size_t length);
+GAME_API ReturnValue gameLoadCards(Game* game, const int cards[]);
+GAME_API ReturnValue gameMove(Game* game, int card, int target_stack);
+GAME_API ReturnValue gameNext(Game* game);
+GAME_API bool gameIsWon(const Game* game);
+GAME_API int gameStackSize(const Game* game, int stack);
+GAME_API ReturnValue gameCard(const Game* game, int stack, int index,
+  int* card);
+GAME_API ReturnValue gameParseCard(const char* color, const char* rank,
+  int* card);
+
+#endif // GAME_H
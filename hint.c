@@ -0,0 +1,171 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hint.h"
+
+//-----------------------------------------------------------------------------
+///
+/// Prepares the search used for hints
+///
+/// @param hinter hinter to initialise
+/// @param tablebase endgame tablebase or NULL
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue hinterInit(Hinter* hinter, const Tablebase* tablebase)
+{
+  ReturnValue return_value = solverInit(&hinter->solver_, HINT_NODE_BUDGET);
+  hinter->solver_.tablebase_ = tablebase;
+  hinter->cancel_ = NULL;
+  hinter->line_ = NULL;
+  hinter->line_length_ = 0;
+  hinter->line_capacity_ = 0;
+  return return_value;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Frees the search used for hints
+///
+/// @param hinter hinter to free
+///
+//
+void hinterFree(Hinter* hinter)
+{
+  solverFree(&hinter->solver_);
+  free(hinter->line_);
+  hinter->line_ = NULL;
+  hinter->line_length_ = 0;
+  hinter->line_capacity_ = 0;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Finds the next move of a winning line. A board on the last winning line
+/// continues it, all others start a new line. Boards covered by the
+/// tablebase are answered by the table, all others by a search within
+/// HINT_NODE_BUDGET boards. A cancelled search returns SOLVE_UNKNOWN.
+///
+/// @param hinter hinter to use
+/// @param board board to find a move for
+/// @param move pointer to store the move, unchanged for a won board
+/// @param moves_to_win pointer to store the remaining length of the line
+///
+/// @return SOLVE_WON if the board can be won, otherwise the result of the
+///         search
+//
+SolveResult findHint(Hinter* hinter, const Board* board, Move* move,
+  int* moves_to_win)
+{
+  unsigned long long key = hashBoard(board);
+  Board position = hinter->line_start_;
+  for (int index = 0; index < hinter->line_length_; index++)
+  {
+    if (hashBoard(&position) == key)
+    {
+      *move = hinter->line_[index];
+      *moves_to_win = hinter->line_length_ - index;
+      return SOLVE_WON;
+    }
+    applyMove(&position, hinter->line_[index]);
+  }
+
+  Solver* solver = &hinter->solver_;
+  if (solverStart(solver, board) != EVERYTHING_OK)
+  {
+    return SOLVE_UNKNOWN;
+  }
+  SolveResult result = SOLVE_RUNNING;
+  while (result == SOLVE_RUNNING)
+  {
+    // A background search gives the processor back after every chunk, so
+    // the game thread never waits for a scheduler tick
+    if (hinter->cancel_ != NULL)
+    {
+      if (atomic_load(hinter->cancel_))
+      {
+        return SOLVE_UNKNOWN;
+      }
+      sched_yield();
+    }
+    result = solverRun(solver, HINT_CHUNK_NODES);
+  }
+  if (result != SOLVE_WON)
+  {
+    return result;
+  }
+  int length = solver->depth_ - 1;
+  if (length > hinter->line_capacity_)
+  {
+    Move* line = (Move*) realloc(hinter->line_, length * sizeof(Move));
+    if (line == NULL)
+    {
+      return SOLVE_UNKNOWN;
+    }
+    hinter->line_ = line;
+    hinter->line_capacity_ = length;
+  }
+  hinter->line_start_ = *board;
+  hinter->line_length_ = solverSolution(solver, hinter->line_, length);
+  *moves_to_win = hinter->line_length_;
+  if (hinter->line_length_ > 0)
+  {
+    *move = hinter->line_[0];
+  }
+  return SOLVE_WON;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Prints a hint for the current board of a game
+///
+/// @param hinter hinter to use
+/// @param stacks array struct of the doubly linked list
+///
+//
+void printHint(Hinter* hinter, Doubly_Linked_List stacks[])
+{
+  Board board;
+  Move move = { 0, 0 };
+  int moves_to_win = 0;
+  boardFromStacks(&board, stacks);
+  SolveResult result = findHint(hinter, &board, &move, &moves_to_win);
+  printHintResult(result, move, moves_to_win);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Prints the answer to a HINT command
+///
+/// @param result result of findHint
+/// @param move move found by findHint
+/// @param moves_to_win remaining length of the winning line
+///
+//
+void printHintResult(SolveResult result, Move move, int moves_to_win)
+{
+  switch (result)
+  {
+  case SOLVE_WON:
+    if (moves_to_win == 0)
+    {
+      printf("[HINT] The game is won!\n");
+      break;
+    }
+    printf("[HINT] Winning line of %d moves, next: ", moves_to_win);
+    printMove(move);
+    break;
+  case SOLVE_LOST:
+    printf("[HINT] The game cannot be won anymore!\n");
+    break;
+  default:
+    printf("[HINT] No winning line found!\n");
+    break;
+  }
+}
@@ -0,0 +1,37 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#ifndef HINT_H
+#define HINT_H
+
+#include <stdatomic.h>
+
+#include "solver.h"
+#include "tablebase.h"
+
+#define HINT_NODE_BUDGET 2000000ULL
+#define HINT_CHUNK_NODES 1024ULL
+
+// Answers the HINT command of an interactive game. The last winning line is
+// kept, so a player who follows the hints gets the rest of the same line.
+// Setting *cancel_ stops a running search between two chunks.
+typedef struct _Hinter_
+{
+  Solver solver_;
+  const atomic_bool* cancel_;
+  Board line_start_;
+  Move* line_;
+  int line_length_;
+  int line_capacity_;
+} Hinter;
+
+ReturnValue hinterInit(Hinter* hinter, const Tablebase* tablebase);
+void hinterFree(Hinter* hinter);
+SolveResult findHint(Hinter* hinter, const Board* board, Move* move,
+  int* moves_to_win);
+void printHint(Hinter* hinter, Doubly_Linked_List stacks[]);
+void printHintResult(SolveResult result, Move move, int moves_to_win);
+
+#endif // HINT_H
@@ -0,0 +1,347 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+// Replays the winning lines printed by ./solitaire --solve through the API of
+// game.h on many threads at once. Every game has to end won. Built with
+// -fsanitize=thread by make check, so games sharing state would be reported.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "game.h"
+#include "util.h"
+
+#define DEFAULT_CHECK_THREADS 16
+#define DEFAULT_CHECK_ROUNDS 20
+#define MAX_CHECK_THREADS 256
+#define LINE_LENGTH 256
+#define WORD_LENGTH 8
+
+// One command of a winning line, next_ is the count of a NEXT command
+typedef struct _Step_
+{
+  int card_;
+  int target_stack_;
+  int next_;
+} Step;
+
+typedef struct _Replay_
+{
+  char* text_;
+  size_t length_;
+  Step* steps_;
+  int step_count_;
+} Replay;
+
+typedef struct _ReplayCheck_
+{
+  Replay* replays_;
+  int replay_count_;
+  int rounds_;
+  pthread_mutex_t mutex_;
+  long long won_;
+  long long failed_;
+} ReplayCheck;
+
+static ReturnValue readDeals(const char* path, ReplayCheck* check);
+static ReturnValue readSolutions(const char* path, ReplayCheck* check);
+static ReturnValue parseStep(char* line, Step* step);
+static void* replayWorker(void* argument);
+static bool replayGame(const Replay* replay);
+static void freeReplays(ReplayCheck* check);
+
+//-----------------------------------------------------------------------------
+///
+/// The replay check
+///
+/// @param argc number of arguments
+/// @param argv CORPUS SOLUTIONS [--threads N] [--rounds N]
+///
+/// @return 0 if every game was won, 1 otherwise
+//
+int main(int argc, char* argv[])
+{
+  int threads = DEFAULT_CHECK_THREADS;
+  ReplayCheck check;
+  memset(&check, 0, sizeof(ReplayCheck));
+  check.rounds_ = DEFAULT_CHECK_ROUNDS;
+
+  Option known[] = {
+    { "--threads", OPTION_INT, &threads },
+    { "--rounds", OPTION_INT, &check.rounds_ } };
+  if (argc < 3 || parseOptions(argc, argv, 3, known,
+    sizeof(known) / sizeof(known[0])) != EVERYTHING_OK || threads < 1 ||
+    MAX_CHECK_THREADS < threads || check.rounds_ < 1)
+  {
+    fprintf(stderr, "Usage: ./librarycheck CORPUS SOLUTIONS [--threads N] "
+      "[--rounds N]\n");
+    return 1;
+  }
+
+  ReturnValue return_value = readDeals(argv[1], &check);
+  if (return_value == EVERYTHING_OK)
+  {
+    return_value = readSolutions(argv[TWO], &check);
+  }
+  if (return_value != EVERYTHING_OK)
+  {
+    freeReplays(&check);
+    return printErrorMessage(return_value);
+  }
+
+  pthread_t workers[MAX_CHECK_THREADS];
+  pthread_mutex_init(&check.mutex_, NULL);
+  int started = 0;
+  for (; started < threads; started++)
+  {
+    if (pthread_create(&workers[started], NULL, replayWorker, &check) != 0)
+    {
+      break;
+    }
+  }
+  for (int index = 0; index < started; index++)
+  {
+    pthread_join(workers[index], NULL);
+  }
+  pthread_mutex_destroy(&check.mutex_);
+
+  printf("replayed %lld games on %d threads: %lld won, %lld failed\n",
+    check.won_ + check.failed_, started, check.won_, check.failed_);
+  bool passed = started == threads && check.failed_ == 0 && check.won_ > 0;
+  freeReplays(&check);
+  return passed ? 0 : 1;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Splits a corpus into the texts of its deals
+///
+/// @param path corpus file, deals separated by empty lines
+/// @param check check to store the deals in
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue readDeals(const char* path, ReplayCheck* check)
+{
+  char line[LINE_LENGTH];
+  int capacity = 0;
+  bool in_deal = false;
+  FILE* file = fopen(path, "r");
+  if (file == NULL)
+  {
+    return INVALID_FILE;
+  }
+
+  while (fgets(line, LINE_LENGTH, file) != NULL)
+  {
+    bool empty = strspn(line, " \r\n") == strlen(line);
+    if (empty)
+    {
+      in_deal = false;
+      continue;
+    }
+    if (!in_deal)
+    {
+      if (check->replay_count_ == capacity)
+      {
+        capacity = capacity == 0 ? SIZE : capacity * TWO;
+        Replay* grown = (Replay*) realloc(check->replays_,
+          capacity * sizeof(Replay));
+        if (grown == NULL)
+        {
+          fclose(file);
+          return OUT_OF_MEMORY;
+        }
+        check->replays_ = grown;
+      }
+      memset(&check->replays_[check->replay_count_++], 0, sizeof(Replay));
+      in_deal = true;
+    }
+    Replay* replay = &check->replays_[check->replay_count_ - 1];
+    size_t length = strlen(line);
+    char* text = (char*) realloc(replay->text_, replay->length_ + length);
+    if (text == NULL)
+    {
+      fclose(file);
+      return OUT_OF_MEMORY;
+    }
+    memcpy(text + replay->length_, line, length);
+    replay->text_ = text;
+    replay->length_ += length;
+  }
+  fclose(file);
+  return check->replay_count_ == 0 ? INVALID_FILE : EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Reads the winning lines of the output of ./solitaire --solve. Deals that
+/// were not won are not replayed.
+///
+/// @param path file with the output
+/// @param check check with the deals read
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue readSolutions(const char* path, ReplayCheck* check)
+{
+  char line[LINE_LENGTH];
+  Replay* replay = NULL;
+  int expected = 0;
+  FILE* file = fopen(path, "r");
+  if (file == NULL)
+  {
+    return INVALID_FILE;
+  }
+
+  ReturnValue return_value = EVERYTHING_OK;
+  while (return_value == EVERYTHING_OK &&
+    fgets(line, LINE_LENGTH, file) != NULL)
+  {
+    int deal;
+    int moves;
+    if (sscanf(line, "deal %d: won in %d moves", &deal, &moves) == TWO)
+    {
+      if (deal < 0 || check->replay_count_ <= deal || moves < 0 ||
+        (replay != NULL && replay->step_count_ != expected))
+      {
+        return_value = INVALID_FILE;
+        break;
+      }
+      replay = &check->replays_[deal];
+      expected = moves;
+      replay->steps_ = (Step*) malloc((moves + 1) * sizeof(Step));
+      return_value = replay->steps_ == NULL ? OUT_OF_MEMORY : EVERYTHING_OK;
+    }
+    else if (strncmp(line, "deal ", strlen("deal ")) == 0 ||
+      strncmp(line, "won ", strlen("won ")) == 0)
+    {
+      return_value = replay != NULL && replay->step_count_ != expected ?
+        INVALID_FILE : EVERYTHING_OK;
+      replay = NULL;
+    }
+    else if (replay != NULL && replay->step_count_ < expected)
+    {
+      return_value = parseStep(line, &replay->steps_[replay->step_count_++]);
+    }
+  }
+  fclose(file);
+  return return_value;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Parses a MOVE or NEXT command as printed by printMove
+///
+/// @param line the command
+/// @param step step to fill
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue parseStep(char* line, Step* step)
+{
+  char color[WORD_LENGTH];
+  char rank[WORD_LENGTH];
+  memset(step, 0, sizeof(Step));
+  if (strncmp(line, "NEXT", strlen("NEXT")) == 0)
+  {
+    step->next_ = 1;
+    sscanf(line, "NEXT %d", &step->next_);
+    return step->next_ > 0 ? EVERYTHING_OK : INVALID_FILE;
+  }
+  if (sscanf(line, "MOVE %7s %7s TO %d", color, rank,
+    &step->target_stack_) != 3)
+  {
+    return INVALID_FILE;
+  }
+  return gameParseCard(color, rank, &step->card_) == EVERYTHING_OK ?
+    EVERYTHING_OK : INVALID_FILE;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Replays every winning line rounds_ times, each game in its own handle
+///
+/// @param argument the ReplayCheck
+///
+/// @return NULL
+//
+static void* replayWorker(void* argument)
+{
+  ReplayCheck* check = (ReplayCheck*) argument;
+  long long won = 0;
+  long long failed = 0;
+  for (int round = 0; round < check->rounds_; round++)
+  {
+    for (int deal = 0; deal < check->replay_count_; deal++)
+    {
+      if (check->replays_[deal].steps_ == NULL)
+      {
+        continue;
+      }
+      replayGame(&check->replays_[deal]) ? won++ : failed++;
+    }
+  }
+  pthread_mutex_lock(&check->mutex_);
+  check->won_ += won;
+  check->failed_ += failed;
+  pthread_mutex_unlock(&check->mutex_);
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Plays one winning line through the API
+///
+/// @param replay deal and winning line
+///
+/// @return boolean data type true or false
+//
+static bool replayGame(const Replay* replay)
+{
+  Game* game = NULL;
+  if (gameCreate(&game) != EVERYTHING_OK)
+  {
+    return false;
+  }
+  bool moved = gameLoadConfig(game, replay->text_, replay->length_) ==
+    EVERYTHING_OK;
+  for (int index = 0; moved && index < replay->step_count_; index++)
+  {
+    const Step* step = &replay->steps_[index];
+    for (int next = 0; moved && next < step->next_; next++)
+    {
+      moved = gameNext(game) == MOVED;
+    }
+    if (step->next_ == 0)
+    {
+      moved = gameMove(game, step->card_, step->target_stack_) == MOVED;
+    }
+  }
+  bool won = moved && gameIsWon(game);
+  gameDestroy(game);
+  return won;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Frees all deals and winning lines
+///
+/// @param check check to free
+///
+//
+static void freeReplays(ReplayCheck* check)
+{
+  for (int deal = 0; deal < check->replay_count_; deal++)
+  {
+    free(check->replays_[deal].text_);
+    free(check->replays_[deal].steps_);
+  }
+  free(check->replays_);
+  check->replays_ = NULL;
+  check->replay_count_ = 0;
+}
@@ -0,0 +1,191 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#include <stdio.h>
+#include <string.h>
+
+#include "solitaire.h"
+#include "analyze.h"
+#include "batch.h"
+#include "evaluate.h"
+#include "hint.h"
+#include "pipeline.h"
+#include "ponder.h"
+#include "publish.h"
+#include "tablebase.h"
+#include "util.h"
+
+// Everything that watches the commands of an interactive game
+typedef struct _Session_
+{
+  bool publish_;
+  Publisher publisher_;
+  Tablebase tablebase_;
+  Hinter hinter_;
+  bool ponder_;
+  Ponderer ponderer_;
+} Session;
+
+static void observeCommand(Doubly_Linked_List stacks[], ReturnValue result,
+  void* context);
+
+//-----------------------------------------------------------------------------
+///
+/// The main program
+/// Checks for file and starts the gameloop
+///
+/// @param argc number of arguments
+/// @param argv program arguments, FILE [--publish NAME] [--tablebase FILE]
+///             [--ponder] for a game
+///
+/// @return value of ReturnValue which defines type of error
+//
+int main(int argc, char* argv[]) {
+
+  if (argc > 1 && strcmp(argv[1], "--evaluate") == 0)
+  {
+    return runEvaluation(argc, argv);
+  }
+  if (argc > 1 && strcmp(argv[1], "--generate") == 0)
+  {
+    return runPipeline(argc, argv);
+  }
+  if (argc > 1 && strcmp(argv[1], "--analyze") == 0)
+  {
+    return runAnalysis(argc, argv);
+  }
+  if (argc > 1 && strcmp(argv[1], "--endgame") == 0)
+  {
+    return runTablebase(argc, argv);
+  }
+  if (argc > 1 && strcmp(argv[1], "--verify") == 0)
+  {
+    return verifyTablebase(argc, argv);
+  }
+  if (argc > 1 && strncmp(argv[1], "--", TWO) == 0)
+  {
+    return runBatch(argc, argv);
+  }
+
+  if (argc < 2)
+  {
+  	return printErrorMessage(INVALID_ARG_COUNT);
+  }
+
+  Session session;
+  memset(&session, 0, sizeof(Session));
+  const char* publish_name = NULL;
+  const char* tablebase_path = NULL;
+  bool ponder = false;
+  Option known[] = {
+    { "--ponder", OPTION_FLAG, &ponder },
+    { "--publish", OPTION_STRING, &publish_name },
+    { "--tablebase", OPTION_STRING, &tablebase_path } };
+  if (parseOptions(argc, argv, TWO, known, sizeof(known) / sizeof(known[0]))
+    != EVERYTHING_OK)
+  {
+    return printErrorMessage(INVALID_ARG_COUNT);
+  }
+
+  Doubly_Linked_List stacks[NUMBER_OF_STACKS] = { NULL };
+
+  FILE* file = fopen(argv[1], "r");
+  if (file == NULL)
+  {
+    return printErrorMessage(INVALID_FILE);
+  }
+
+  ReturnValue return_value = readConfig(file, &stacks[0]);
+  fclose(file);
+  if(return_value != EVERYTHING_OK)
+  {
+    deleteStacks(stacks);
+    return printErrorMessage(return_value);
+  }
+
+  arrangeCards(stacks);
+
+  if (tablebase_path != NULL)
+  {
+    return_value = tablebaseLoad(&session.tablebase_, tablebase_path);
+  }
+  if (return_value == EVERYTHING_OK)
+  {
+    return_value = hinterInit(&session.hinter_, &session.tablebase_);
+  }
+  if (return_value == EVERYTHING_OK && ponder)
+  {
+    return_value = pondererStart(&session.ponderer_, &session.tablebase_,
+      stacks);
+    session.ponder_ = return_value == EVERYTHING_OK;
+  }
+  if (return_value == EVERYTHING_OK && publish_name != NULL)
+  {
+    return_value = publisherOpen(&session.publisher_, publish_name, stacks);
+    session.publish_ = return_value == EVERYTHING_OK;
+  }
+  if (return_value != EVERYTHING_OK)
+  {
+    if (session.ponder_)
+    {
+      pondererStop(&session.ponderer_);
+    }
+    hinterFree(&session.hinter_);
+    tablebaseFree(&session.tablebase_);
+    deleteStacks(stacks);
+    return printErrorMessage(return_value);
+  }
+
+  printGame(stacks);
+  return_value = playGame(stacks, stdin, observeCommand, &session);
+  if (session.publish_)
+  {
+    publisherClose(&session.publisher_);
+  }
+  if (session.ponder_)
+  {
+    pondererStop(&session.ponderer_);
+  }
+  hinterFree(&session.hinter_);
+  tablebaseFree(&session.tablebase_);
+  deleteStacks(stacks);
+  if (return_value != EVERYTHING_OK)
+  {
+    return printErrorMessage(return_value);
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Answers HINT commands, hands changed boards to the ponderer and
+/// publishes the board after every command
+///
+/// @param stacks array struct of the doubly linked list
+/// @param result result of the command
+/// @param context pointer to the Session
+///
+//
+static void observeCommand(Doubly_Linked_List stacks[], ReturnValue result,
+  void* context)
+{
+  Session* session = (Session*) context;
+  if (result == MOVED && session->ponder_)
+  {
+    pondererUpdate(&session->ponderer_, stacks);
+  }
+  if (result == SHOW_HINT && session->ponder_)
+  {
+    printPonderedHint(&session->ponderer_, &session->hinter_, stacks);
+  }
+  else if (result == SHOW_HINT)
+  {
+    printHint(&session->hinter_, stacks);
+  }
+  if (session->publish_)
+  {
+    publishCommand(stacks, result, &session->publisher_);
+  }
+}
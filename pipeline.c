@@ -0,0 +1,616 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pipeline.h"
+#include "trace.h"
+#include "util.h"
+
+#define BUCKET_PATH_SIZE 64
+
+typedef struct _Pipeline_
+{
+  long long target_;
+  unsigned long long seed_;
+  unsigned long long budget_;
+  int threads_;
+  int bucket_width_;
+  const char* output_path_;
+  DealQueue candidates_;
+  DealQueue solved_;
+  atomic_llong won_;
+  atomic_llong lost_;
+  atomic_llong unknown_;
+  atomic_int error_;
+} Pipeline;
+
+// Holds solved deals until all deals with a lower index are solved, so the
+// corpus is written in seed order however the solver threads finish
+typedef struct _ReorderBuffer_
+{
+  PipelineDeal* deals_;
+  bool* ready_;
+  long long next_;
+  int capacity_;
+} ReorderBuffer;
+
+static ReturnValue parsePipelineOptions(int argc, char* argv[],
+  Pipeline* pipeline, const char** trace_path);
+static void* producerStage(void* argument);
+static void* solverStage(void* argument);
+static FILE* bucketFile(const Pipeline* pipeline, FILE* files[],
+  int solution_length);
+static ReturnValue reorderInit(ReorderBuffer* reorder, int capacity);
+static ReturnValue reorderPut(ReorderBuffer* reorder,
+  const PipelineDeal* deal);
+static bool reorderTake(ReorderBuffer* reorder, PipelineDeal* deal);
+static void reorderFree(ReorderBuffer* reorder);
+
+//-----------------------------------------------------------------------------
+///
+/// Generates random deals, filters them through the solver and writes the
+/// solvable ones to a corpus file. One thread shuffles deals, the solver
+/// threads take them from a bounded queue and hand every result to the
+/// main thread, which writes the won ones in seed order.
+///
+/// @param argc number of arguments
+/// @param argv --generate N --output FILE [--buckets WIDTH] [--budget N]
+///             [--seed N] [--threads N] [--trace FILE]
+///
+/// @return exit code of the program
+//
+int runPipeline(int argc, char* argv[])
+{
+  Pipeline pipeline;
+  const char* trace_path = NULL;
+  memset(&pipeline, 0, sizeof(Pipeline));
+  ReturnValue return_value = parsePipelineOptions(argc, argv, &pipeline,
+    &trace_path);
+  if (return_value != EVERYTHING_OK)
+  {
+    return printErrorMessage(return_value);
+  }
+
+  FILE* files[MAX_BUCKETS] = { NULL };
+  if (pipeline.bucket_width_ == 0)
+  {
+    files[0] = fopen(pipeline.output_path_, "w");
+    if (files[0] == NULL)
+    {
+      return printErrorMessage(INVALID_FILE);
+    }
+  }
+  ReorderBuffer reorder;
+  return_value = reorderInit(&reorder, PIPELINE_QUEUE_SIZE);
+  if (return_value == EVERYTHING_OK)
+  {
+    return_value = queueInit(&pipeline.candidates_, PIPELINE_QUEUE_SIZE);
+  }
+  if (return_value == EVERYTHING_OK)
+  {
+    return_value = queueInit(&pipeline.solved_, PIPELINE_QUEUE_SIZE);
+  }
+  if (return_value == EVERYTHING_OK && trace_path != NULL)
+  {
+    return_value = traceStart(trace_path);
+  }
+  if (return_value != EVERYTHING_OK)
+  {
+    reorderFree(&reorder);
+    queueFree(&pipeline.candidates_);
+    queueFree(&pipeline.solved_);
+    if (files[0] != NULL)
+    {
+      fclose(files[0]);
+    }
+    return printErrorMessage(return_value);
+  }
+  traceThreadName("writer");
+
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  pthread_t producer;
+  pthread_t* solvers = (pthread_t*) malloc(pipeline.threads_ *
+    sizeof(pthread_t));
+  int started = 0;
+  bool producing = solvers != NULL &&
+    pthread_create(&producer, NULL, producerStage, &pipeline) == 0;
+  for (; producing && started < pipeline.threads_; started++)
+  {
+    if (pthread_create(&solvers[started], NULL, solverStage, &pipeline) != 0)
+    {
+      break;
+    }
+  }
+
+  long long accepted = 0;
+  double last_report = 0;
+  PipelineDeal deal;
+  bool writing = started > 0;
+  while (writing && accepted < pipeline.target_ &&
+    queuePop(&pipeline.solved_, &deal))
+  {
+    if (reorderPut(&reorder, &deal) != EVERYTHING_OK)
+    {
+      atomic_store(&pipeline.error_, OUT_OF_MEMORY);
+      break;
+    }
+    while (accepted < pipeline.target_ && reorderTake(&reorder, &deal))
+    {
+      if (deal.solution_length_ == REJECTED_DEAL)
+      {
+        continue;
+      }
+      unsigned long long write_start = TRACE_BEGIN();
+      FILE* file = bucketFile(&pipeline, files, deal.solution_length_);
+      if (file == NULL)
+      {
+        atomic_store(&pipeline.error_, INVALID_FILE);
+        writing = false;
+        break;
+      }
+      writeDeal(file, deal.cards_);
+      accepted++;
+      TRACE_END("write", write_start, "deal", deal.index_);
+    }
+
+    double seconds = secondsSince(&start);
+    if (seconds - last_report >= REPORT_SECONDS)
+    {
+      printf("accepted %lld of %lld deals, %.0f accepted deals/s\n",
+        accepted, atomic_load(&pipeline.won_) + atomic_load(&pipeline.lost_) +
+        atomic_load(&pipeline.unknown_), accepted / seconds);
+      fflush(stdout);
+      last_report = seconds;
+    }
+  }
+
+  queueClose(&pipeline.candidates_);
+  queueClose(&pipeline.solved_);
+  if (producing)
+  {
+    pthread_join(producer, NULL);
+  }
+  for (int index = 0; index < started; index++)
+  {
+    pthread_join(solvers[index], NULL);
+  }
+  double seconds = secondsSince(&start);
+  for (int bucket = 0; bucket < MAX_BUCKETS; bucket++)
+  {
+    if (files[bucket] != NULL)
+    {
+      fclose(files[bucket]);
+    }
+  }
+  traceStop();
+  free(solvers);
+  reorderFree(&reorder);
+  queueFree(&pipeline.candidates_);
+  queueFree(&pipeline.solved_);
+
+  return_value = atomic_load(&pipeline.error_);
+  if (return_value == EVERYTHING_OK && started == 0)
+  {
+    return_value = UNIDENTIFIED_ERROR;
+  }
+  if (return_value != EVERYTHING_OK)
+  {
+    return printErrorMessage(return_value);
+  }
+  printf("accepted %lld deals, solved %lld (won %lld, lost %lld, unknown "
+    "%lld) in %.2f s, %.0f accepted deals/s\n", accepted,
+    atomic_load(&pipeline.won_) + atomic_load(&pipeline.lost_) +
+    atomic_load(&pipeline.unknown_), atomic_load(&pipeline.won_),
+    atomic_load(&pipeline.lost_), atomic_load(&pipeline.unknown_), seconds,
+    accepted / seconds);
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Reads the command line of a generation run
+///
+/// @param argc number of arguments
+/// @param argv program arguments
+/// @param pipeline pipeline to configure
+/// @param trace_path pointer to store the trace file
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue parsePipelineOptions(int argc, char* argv[],
+  Pipeline* pipeline, const char** trace_path)
+{
+  long processors = sysconf(_SC_NPROCESSORS_ONLN);
+  pipeline->threads_ = processors > 0 ? (int)processors : 1;
+  pipeline->budget_ = DEFAULT_PIPELINE_BUDGET;
+  pipeline->seed_ = 1;
+
+  Option known[] = {
+    { "--generate", OPTION_LONG_LONG, &pipeline->target_ },
+    { "--output", OPTION_STRING, &pipeline->output_path_ },
+    { "--buckets", OPTION_INT, &pipeline->bucket_width_ },
+    { "--budget", OPTION_UNSIGNED, &pipeline->budget_ },
+    { "--seed", OPTION_UNSIGNED, &pipeline->seed_ },
+    { "--threads", OPTION_INT, &pipeline->threads_ },
+    { "--trace", OPTION_STRING, trace_path } };
+  if (parseOptions(argc, argv, 1, known, sizeof(known) / sizeof(known[0])) !=
+    EVERYTHING_OK || pipeline->target_ < 1 ||
+    pipeline->output_path_ == NULL || pipeline->bucket_width_ < 0 ||
+    pipeline->budget_ == 0 || pipeline->threads_ < 1)
+  {
+    return INVALID_ARG_COUNT;
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Shuffles seeded deals until the candidate queue is closed
+///
+/// @param argument pointer to the Pipeline
+///
+/// @return NULL
+//
+static void* producerStage(void* argument)
+{
+  Pipeline* pipeline = (Pipeline*) argument;
+  PipelineDeal deal;
+  traceThreadName("producer");
+
+  for (deal.index_ = 0; ; deal.index_++)
+  {
+    shuffleDeal(dealSeed(pipeline->seed_, deal.index_), deal.cards_);
+    deal.solution_length_ = 0;
+    if (!queuePush(&pipeline->candidates_, &deal))
+    {
+      break;
+    }
+  }
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Solves candidates within the budget and passes them on, the ones not
+/// won marked as REJECTED_DEAL
+///
+/// @param argument pointer to the Pipeline
+///
+/// @return NULL
+//
+static void* solverStage(void* argument)
+{
+  Pipeline* pipeline = (Pipeline*) argument;
+  PipelineDeal deal;
+  Board board;
+  Solver solver;
+  traceThreadName("solver");
+
+  if (solverInit(&solver, pipeline->budget_) != EVERYTHING_OK)
+  {
+    atomic_store(&pipeline->error_, OUT_OF_MEMORY);
+    queueClose(&pipeline->solved_);
+    return NULL;
+  }
+  while (queuePop(&pipeline->candidates_, &deal))
+  {
+    unsigned long long start = TRACE_BEGIN();
+    boardFromDeal(&board, deal.cards_);
+    SolveResult result = solverStart(&solver, &board) == EVERYTHING_OK ?
+      solverRun(&solver, pipeline->budget_) : SOLVE_UNKNOWN;
+    TRACE_END("search", start, "deal", deal.index_);
+
+    deal.solution_length_ = REJECTED_DEAL;
+    if (result == SOLVE_WON)
+    {
+      atomic_fetch_add(&pipeline->won_, 1);
+      deal.solution_length_ = solver.depth_ - 1;
+    }
+    else
+    {
+      atomic_fetch_add(result == SOLVE_LOST ? &pipeline->lost_ :
+        &pipeline->unknown_, 1);
+    }
+    if (!queuePush(&pipeline->solved_, &deal))
+    {
+      break;
+    }
+  }
+  solverFree(&solver);
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Returns the output file for a solution length. With a bucket width the
+/// deals are split into files named FILE.<shortest>-<longest>, the last
+/// bucket takes all longer solutions and is named FILE.<shortest>-.
+///
+/// @param pipeline pipeline with output path and bucket width
+/// @param files open file of every bucket
+/// @param solution_length number of moves of the found solution
+///
+/// @return the file or NULL if it can not be opened
+//
+static FILE* bucketFile(const Pipeline* pipeline, FILE* files[],
+  int solution_length)
+{
+  if (pipeline->bucket_width_ == 0)
+  {
+    return files[0];
+  }
+  int bucket = solution_length / pipeline->bucket_width_;
+  if (bucket >= MAX_BUCKETS)
+  {
+    bucket = MAX_BUCKETS - 1;
+  }
+  if (files[bucket] == NULL)
+  {
+    int shortest = bucket * pipeline->bucket_width_;
+    size_t size = strlen(pipeline->output_path_) + BUCKET_PATH_SIZE;
+    char* path = (char*) malloc(size);
+    if (path == NULL)
+    {
+      return NULL;
+    }
+    if (bucket == MAX_BUCKETS - 1)
+    {
+      snprintf(path, size, "%s.%d-", pipeline->output_path_, shortest);
+    }
+    else
+    {
+      snprintf(path, size, "%s.%d-%d", pipeline->output_path_, shortest,
+        shortest + pipeline->bucket_width_ - 1);
+    }
+    files[bucket] = fopen(path, "w");
+    free(path);
+  }
+  return files[bucket];
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Allocates an empty reorder buffer waiting for deal 0
+///
+/// @param reorder buffer to initialise
+/// @param capacity number of deals it can hold before it grows
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue reorderInit(ReorderBuffer* reorder, int capacity)
+{
+  reorder->deals_ = (PipelineDeal*) malloc(capacity * sizeof(PipelineDeal));
+  reorder->ready_ = (bool*) calloc(capacity, sizeof(bool));
+  reorder->next_ = 0;
+  reorder->capacity_ = capacity;
+  if (reorder->deals_ == NULL || reorder->ready_ == NULL)
+  {
+    reorderFree(reorder);
+    return OUT_OF_MEMORY;
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Stores a solved deal at its index. The buffer doubles while a deal is
+/// further ahead of the next one to write than it can hold.
+///
+/// @param reorder buffer to store in
+/// @param deal the solved deal
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue reorderPut(ReorderBuffer* reorder, const PipelineDeal* deal)
+{
+  while (deal->index_ - reorder->next_ >= reorder->capacity_)
+  {
+    int capacity = reorder->capacity_ * TWO;
+    PipelineDeal* deals = (PipelineDeal*) malloc(capacity *
+      sizeof(PipelineDeal));
+    bool* ready = (bool*) calloc(capacity, sizeof(bool));
+    if (deals == NULL || ready == NULL)
+    {
+      free(deals);
+      free(ready);
+      return OUT_OF_MEMORY;
+    }
+    for (long long index = reorder->next_;
+      index < reorder->next_ + reorder->capacity_; index++)
+    {
+      deals[index % capacity] = reorder->deals_[index % reorder->capacity_];
+      ready[index % capacity] = reorder->ready_[index % reorder->capacity_];
+    }
+    free(reorder->deals_);
+    free(reorder->ready_);
+    reorder->deals_ = deals;
+    reorder->ready_ = ready;
+    reorder->capacity_ = capacity;
+  }
+  int slot = deal->index_ % reorder->capacity_;
+  reorder->deals_[slot] = *deal;
+  reorder->ready_[slot] = true;
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Takes the next deal in seed order if it is solved
+///
+/// @param reorder buffer to take from
+/// @param deal pointer to store the deal
+///
+/// @return false if the next deal is still being solved
+//
+static bool reorderTake(ReorderBuffer* reorder, PipelineDeal* deal)
+{
+  int slot = reorder->next_ % reorder->capacity_;
+  if (!reorder->ready_[slot])
+  {
+    return false;
+  }
+  *deal = reorder->deals_[slot];
+  reorder->ready_[slot] = false;
+  reorder->next_++;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Frees a reorder buffer
+///
+/// @param reorder buffer to free
+///
+//
+static void reorderFree(ReorderBuffer* reorder)
+{
+  free(reorder->deals_);
+  free(reorder->ready_);
+  reorder->deals_ = NULL;
+  reorder->ready_ = NULL;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Writes a deal in the format read by readConfig, followed by an empty line
+///
+/// @param file file to write to
+/// @param cards the cards of the deal in the order of the config file
+///
+//
+void writeDeal(FILE* file, const int cards[])
+{
+
+  for (int card = 0; card < NUMBER_OF_CARDS; card++)
+  {
+    fprintf(file, "%s %s\n", cards[card] % TWO == 0 ? "BLACK" : "RED",
+      rankName(cards[card]));
+  }
+  fprintf(file, "\n");
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Allocates a bounded queue
+///
+/// @param queue queue to initialise
+/// @param capacity maximum number of deals in the queue
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue queueInit(DealQueue* queue, int capacity)
+{
+  queue->items_ = (PipelineDeal*) malloc(capacity * sizeof(PipelineDeal));
+  if (queue->items_ == NULL)
+  {
+    return OUT_OF_MEMORY;
+  }
+  queue->capacity_ = capacity;
+  queue->head_ = 0;
+  queue->count_ = 0;
+  queue->closed_ = false;
+  pthread_mutex_init(&queue->lock_, NULL);
+  pthread_cond_init(&queue->not_empty_, NULL);
+  pthread_cond_init(&queue->not_full_, NULL);
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Adds a deal, waits while the queue is full
+///
+/// @param queue queue to add to
+/// @param deal deal to copy into the queue
+///
+/// @return false if the queue was closed
+//
+bool queuePush(DealQueue* queue, const PipelineDeal* deal)
+{
+  pthread_mutex_lock(&queue->lock_);
+  while (queue->count_ == queue->capacity_ && !queue->closed_)
+  {
+    pthread_cond_wait(&queue->not_full_, &queue->lock_);
+  }
+  bool pushed = !queue->closed_;
+  if (pushed)
+  {
+    queue->items_[(queue->head_ + queue->count_) % queue->capacity_] = *deal;
+    queue->count_++;
+    pthread_cond_signal(&queue->not_empty_);
+  }
+  pthread_mutex_unlock(&queue->lock_);
+  return pushed;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Takes the oldest deal, waits while the queue is empty
+///
+/// @param queue queue to take from
+/// @param deal pointer to store the deal
+///
+/// @return false if the queue was closed
+//
+bool queuePop(DealQueue* queue, PipelineDeal* deal)
+{
+  pthread_mutex_lock(&queue->lock_);
+  while (queue->count_ == 0 && !queue->closed_)
+  {
+    pthread_cond_wait(&queue->not_empty_, &queue->lock_);
+  }
+  bool popped = !queue->closed_;
+  if (popped)
+  {
+    *deal = queue->items_[queue->head_];
+    queue->head_ = (queue->head_ + 1) % queue->capacity_;
+    queue->count_--;
+    pthread_cond_signal(&queue->not_full_);
+  }
+  pthread_mutex_unlock(&queue->lock_);
+  return popped;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Closes the queue and wakes all waiting threads
+///
+/// @param queue queue to close
+///
+//
+void queueClose(DealQueue* queue)
+{
+  pthread_mutex_lock(&queue->lock_);
+  queue->closed_ = true;
+  pthread_cond_broadcast(&queue->not_empty_);
+  pthread_cond_broadcast(&queue->not_full_);
+  pthread_mutex_unlock(&queue->lock_);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Frees a queue
+///
+/// @param queue queue to free
+///
+//
+void queueFree(DealQueue* queue)
+{
+  if (queue->items_ == NULL)
+  {
+    return;
+  }
+  free(queue->items_);
+  queue->items_ = NULL;
+  pthread_cond_destroy(&queue->not_full_);
+  pthread_cond_destroy(&queue->not_empty_);
+  pthread_mutex_destroy(&queue->lock_);
+}
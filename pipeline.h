@@ -0,0 +1,48 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <pthread.h>
+
+#include "solver.h"
+
+#define DEFAULT_PIPELINE_BUDGET 200000ULL
+#define PIPELINE_QUEUE_SIZE 1024
+#define MAX_BUCKETS 1024
+#define REPORT_SECONDS 1.0
+#define REJECTED_DEAL -1
+
+// A solved candidate, solution_length_ is REJECTED_DEAL if it was not won
+typedef struct _PipelineDeal_
+{
+  long long index_;
+  int cards_[NUMBER_OF_CARDS];
+  int solution_length_;
+} PipelineDeal;
+
+// Bounded blocking queue between two stages of the pipeline
+typedef struct _DealQueue_
+{
+  PipelineDeal* items_;
+  int capacity_;
+  int head_;
+  int count_;
+  bool closed_;
+  pthread_mutex_t lock_;
+  pthread_cond_t not_empty_;
+  pthread_cond_t not_full_;
+} DealQueue;
+
+ReturnValue queueInit(DealQueue* queue, int capacity);
+bool queuePush(DealQueue* queue, const PipelineDeal* deal);
+bool queuePop(DealQueue* queue, PipelineDeal* deal);
+void queueClose(DealQueue* queue);
+void queueFree(DealQueue* queue);
+void writeDeal(FILE* file, const int cards[]);
+int runPipeline(int argc, char* argv[]);
+
+#endif // PIPELINE_H
@@ -0,0 +1,207 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ponder.h"
+
+static void* ponderWorker(void* argument);
+static PonderEntry* cacheSlot(Ponderer* ponderer, unsigned long long key);
+
+//-----------------------------------------------------------------------------
+///
+/// Starts pondering on the first board of a game
+///
+/// @param ponderer ponderer to start
+/// @param tablebase endgame tablebase or NULL
+/// @param stacks array struct of the doubly linked list
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue pondererStart(Ponderer* ponderer, const Tablebase* tablebase,
+  Doubly_Linked_List stacks[])
+{
+  memset(ponderer, 0, sizeof(Ponderer));
+  ReturnValue return_value = hinterInit(&ponderer->hinter_, tablebase);
+  if (return_value != EVERYTHING_OK)
+  {
+    hinterFree(&ponderer->hinter_);
+    return return_value;
+  }
+  atomic_init(&ponderer->cancel_, false);
+  ponderer->hinter_.cancel_ = &ponderer->cancel_;
+  boardFromStacks(&ponderer->board_, stacks);
+  ponderer->generation_ = 1;
+  ponderer->running_ = true;
+  pthread_mutex_init(&ponderer->lock_, NULL);
+  pthread_cond_init(&ponderer->changed_, NULL);
+  if (pthread_create(&ponderer->thread_, NULL, ponderWorker, ponderer) != 0)
+  {
+    pthread_cond_destroy(&ponderer->changed_);
+    pthread_mutex_destroy(&ponderer->lock_);
+    hinterFree(&ponderer->hinter_);
+    return UNIDENTIFIED_ERROR;
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Posts the board after a command that changed it. The running search is
+/// cancelled and the worker starts on the new board. The game only holds
+/// the lock to copy the board, never while the worker searches.
+///
+/// @param ponderer ponderer of the game
+/// @param stacks array struct of the doubly linked list
+///
+//
+void pondererUpdate(Ponderer* ponderer, Doubly_Linked_List stacks[])
+{
+  Board board;
+  boardFromStacks(&board, stacks);
+  pthread_mutex_lock(&ponderer->lock_);
+  ponderer->board_ = board;
+  ponderer->generation_++;
+  atomic_store(&ponderer->cancel_, true);
+  pthread_cond_broadcast(&ponderer->changed_);
+  pthread_mutex_unlock(&ponderer->lock_);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Prints the hint for the current board. If the worker has not finished
+/// the board yet, it already searches it, so the game waits for its result
+/// instead of searching a second time. If the worker moved on without
+/// keeping the board, the game searches it itself.
+///
+/// @param ponderer ponderer of the game
+/// @param hinter search of the game thread for boards the worker missed
+/// @param stacks array struct of the doubly linked list
+///
+//
+void printPonderedHint(Ponderer* ponderer, Hinter* hinter,
+  Doubly_Linked_List stacks[])
+{
+  Board board;
+  boardFromStacks(&board, stacks);
+  unsigned long long key = hashBoard(&board);
+
+  pthread_mutex_lock(&ponderer->lock_);
+  PonderEntry* entry = cacheSlot(ponderer, key);
+  while (entry->key_ != key && ponderer->pondered_ != ponderer->generation_)
+  {
+    pthread_cond_wait(&ponderer->changed_, &ponderer->lock_);
+  }
+  PonderEntry found = *entry;
+  pthread_mutex_unlock(&ponderer->lock_);
+
+  if (found.key_ != key)
+  {
+    found.key_ = key;
+    found.result_ = findHint(hinter, &board, &found.move_,
+      &found.moves_to_win_);
+    pthread_mutex_lock(&ponderer->lock_);
+    *cacheSlot(ponderer, key) = found;
+    pthread_mutex_unlock(&ponderer->lock_);
+  }
+  printHintResult(found.result_, found.move_, found.moves_to_win_);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Stops the worker and frees its search
+///
+/// @param ponderer ponderer to stop
+///
+//
+void pondererStop(Ponderer* ponderer)
+{
+  pthread_mutex_lock(&ponderer->lock_);
+  ponderer->running_ = false;
+  atomic_store(&ponderer->cancel_, true);
+  pthread_cond_broadcast(&ponderer->changed_);
+  pthread_mutex_unlock(&ponderer->lock_);
+  pthread_join(ponderer->thread_, NULL);
+  pthread_cond_destroy(&ponderer->changed_);
+  pthread_mutex_destroy(&ponderer->lock_);
+  hinterFree(&ponderer->hinter_);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Searches the newest board whenever one was posted. The thread runs with
+/// SCHED_IDLE, so it only gets processor time the game does not use.
+///
+/// @param argument pointer to the Ponderer
+///
+/// @return NULL
+//
+static void* ponderWorker(void* argument)
+{
+  Ponderer* ponderer = (Ponderer*) argument;
+  struct sched_param parameter;
+  memset(&parameter, 0, sizeof(parameter));
+  pthread_setschedparam(pthread_self(), SCHED_IDLE, &parameter);
+
+  pthread_mutex_lock(&ponderer->lock_);
+  while (ponderer->running_)
+  {
+    if (ponderer->pondered_ == ponderer->generation_)
+    {
+      pthread_cond_wait(&ponderer->changed_, &ponderer->lock_);
+      continue;
+    }
+    unsigned long long generation = ponderer->generation_;
+    Board board = ponderer->board_;
+    atomic_store(&ponderer->cancel_, false);
+    PonderEntry entry;
+    memset(&entry, 0, sizeof(PonderEntry));
+    entry.key_ = hashBoard(&board);
+    bool cached = cacheSlot(ponderer, entry.key_)->key_ == entry.key_;
+    pthread_mutex_unlock(&ponderer->lock_);
+
+    if (!cached)
+    {
+      // Lets the game finish the command that posted the board first
+      sched_yield();
+      entry.result_ = findHint(&ponderer->hinter_, &board, &entry.move_,
+        &entry.moves_to_win_);
+    }
+
+    pthread_mutex_lock(&ponderer->lock_);
+    // A finished search is kept even if the board changed meanwhile
+    if (!cached && (entry.result_ != SOLVE_UNKNOWN ||
+      generation == ponderer->generation_))
+    {
+      *cacheSlot(ponderer, entry.key_) = entry;
+    }
+    if (generation == ponderer->generation_)
+    {
+      ponderer->pondered_ = generation;
+      pthread_cond_broadcast(&ponderer->changed_);
+    }
+  }
+  pthread_mutex_unlock(&ponderer->lock_);
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Finds the cache slot of a board, a later board with the same slot
+/// replaces it
+///
+/// @param ponderer ponderer with the cache
+/// @param key hashBoard of the board
+///
+/// @return pointer to the slot, its key_ is 0 or another board if the board
+///         is not cached
+//
+static PonderEntry* cacheSlot(Ponderer* ponderer, unsigned long long key)
+{
+  return &ponderer->cache_[key & (PONDER_CACHE_SIZE - 1)];
+}
@@ -0,0 +1,49 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#ifndef PONDER_H
+#define PONDER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "hint.h"
+
+#define PONDER_CACHE_SIZE 4096
+
+// Hint for one board, found while the player was thinking
+typedef struct _PonderEntry_
+{
+  unsigned long long key_;
+  SolveResult result_;
+  Move move_;
+  int moves_to_win_;
+} PonderEntry;
+
+// Background search of an interactive game. The game posts every new board,
+// which cancels the running search, and the worker searches the newest board
+// while the game waits for input. Results are cached by the board hash.
+typedef struct _Ponderer_
+{
+  pthread_t thread_;
+  pthread_mutex_t lock_;
+  pthread_cond_t changed_;
+  Hinter hinter_;
+  Board board_;
+  unsigned long long generation_;
+  unsigned long long pondered_;
+  atomic_bool cancel_;
+  bool running_;
+  PonderEntry cache_[PONDER_CACHE_SIZE];
+} Ponderer;
+
+ReturnValue pondererStart(Ponderer* ponderer, const Tablebase* tablebase,
+  Doubly_Linked_List stacks[]);
+void pondererUpdate(Ponderer* ponderer, Doubly_Linked_List stacks[]);
+void printPonderedHint(Ponderer* ponderer, Hinter* hinter,
+  Doubly_Linked_List stacks[]);
+void pondererStop(Ponderer* ponderer);
+
+#endif // PONDER_H
@@ -0,0 +1,299 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "publish.h"
+
+static void writeSnapshot(SharedBoard* shared, const BoardSnapshot* snapshot);
+static bool staleSegment(const char* segment);
+
+//-----------------------------------------------------------------------------
+///
+/// Turns NAME into the /NAME form shm_open expects
+///
+/// @param name name given on the command line
+/// @param buffer buffer of PUBLISH_NAME_SIZE bytes for the segment name
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue segmentName(const char* name, char buffer[])
+{
+  int length = snprintf(buffer, PUBLISH_NAME_SIZE, "%s%s",
+    name[0] == '/' ? "" : "/", name);
+  if (length <= 1 || length >= PUBLISH_NAME_SIZE || strchr(buffer + 1, '/'))
+  {
+    return INVALID_SHARED_MEMORY;
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Creates the shared memory segment and publishes the start of the game
+///
+/// @param publisher publisher to set up
+/// @param name name of the segment
+/// @param stacks array struct of the doubly linked list
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue publisherOpen(Publisher* publisher, const char* name,
+  Doubly_Linked_List stacks[])
+{
+  memset(publisher, 0, sizeof(Publisher));
+  if (segmentName(name, publisher->name_) != EVERYTHING_OK)
+  {
+    return INVALID_SHARED_MEMORY;
+  }
+
+  // A segment of a running game is never taken over. One left behind by a
+  // game that was killed is replaced, readers still mapping it keep the old
+  // one.
+  int descriptor = shm_open(publisher->name_, O_CREAT | O_EXCL | O_RDWR,
+    0644);
+  bool taken = descriptor < 0 && errno == EEXIST;
+  if (taken && staleSegment(publisher->name_))
+  {
+    shm_unlink(publisher->name_);
+    descriptor = shm_open(publisher->name_, O_CREAT | O_EXCL | O_RDWR, 0644);
+    taken = descriptor < 0 && errno == EEXIST;
+  }
+  if (descriptor < 0)
+  {
+    return taken ? SHARED_MEMORY_IN_USE : INVALID_SHARED_MEMORY;
+  }
+  if (ftruncate(descriptor, sizeof(SharedBoard)) != 0)
+  {
+    close(descriptor);
+    shm_unlink(publisher->name_);
+    return INVALID_SHARED_MEMORY;
+  }
+  void* memory = mmap(NULL, sizeof(SharedBoard), PROT_READ | PROT_WRITE,
+    MAP_SHARED, descriptor, 0);
+  close(descriptor);
+  if (memory == MAP_FAILED)
+  {
+    shm_unlink(publisher->name_);
+    return INVALID_SHARED_MEMORY;
+  }
+
+  publisher->shared_ = (SharedBoard*) memory;
+  publisher->snapshot_.running_ = true;
+  publisher->snapshot_.result_ = EVERYTHING_OK;
+  boardFromStacks(&publisher->snapshot_.board_, stacks);
+  writeSnapshot(publisher->shared_, &publisher->snapshot_);
+  publisher->shared_->version_ = PUBLISH_VERSION;
+  publisher->shared_->writer_ = getpid();
+  // Readers check the magic number last, so they never see a half set up
+  // segment
+  atomic_thread_fence(memory_order_release);
+  publisher->shared_->magic_ = PUBLISH_MAGIC;
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Publishes the board after a command. Used as CommandObserver of playGame,
+/// it never waits for the readers.
+///
+/// @param stacks array struct of the doubly linked list
+/// @param result return value of the command
+/// @param context the Publisher
+///
+//
+void publishCommand(Doubly_Linked_List stacks[], ReturnValue result,
+  void* context)
+{
+  Publisher* publisher = (Publisher*) context;
+  publisher->snapshot_.commands_++;
+  publisher->snapshot_.result_ = result;
+  boardFromStacks(&publisher->snapshot_.board_, stacks);
+  writeSnapshot(publisher->shared_, &publisher->snapshot_);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Marks the game as ended and removes the segment. Readers that mapped it
+/// keep the last snapshot.
+///
+/// @param publisher publisher to close
+///
+//
+void publisherClose(Publisher* publisher)
+{
+  if (publisher->shared_ == NULL)
+  {
+    return;
+  }
+  publisher->snapshot_.running_ = false;
+  writeSnapshot(publisher->shared_, &publisher->snapshot_);
+  munmap(publisher->shared_, sizeof(SharedBoard));
+  shm_unlink(publisher->name_);
+  publisher->shared_ = NULL;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Checks if an existing segment was published by a game that is gone.
+/// Segments of other programs or versions are never considered stale.
+///
+/// @param segment name of the segment
+///
+/// @return boolean data type true or false
+//
+static bool staleSegment(const char* segment)
+{
+  const SharedBoard* shared = NULL;
+  if (subscriberOpen(segment, &shared) != EVERYTHING_OK)
+  {
+    return false;
+  }
+  bool stale = !writerAlive(shared);
+  subscriberClose(shared);
+  return stale;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Writes a snapshot under the seqlock
+///
+/// @param shared the shared memory segment
+/// @param snapshot snapshot to copy
+///
+//
+static void writeSnapshot(SharedBoard* shared, const BoardSnapshot* snapshot)
+{
+  unsigned int sequence = atomic_load_explicit(&shared->sequence_,
+    memory_order_relaxed);
+  atomic_store_explicit(&shared->sequence_, sequence + 1,
+    memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  memcpy(&shared->snapshot_, snapshot, sizeof(BoardSnapshot));
+  atomic_store_explicit(&shared->sequence_, sequence + TWO,
+    memory_order_release);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Maps the segment of a running game read only
+///
+/// @param name name of the segment
+/// @param shared pointer to store the mapping
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue subscriberOpen(const char* name, const SharedBoard** shared)
+{
+  char segment[PUBLISH_NAME_SIZE];
+  struct stat status;
+  if (segmentName(name, segment) != EVERYTHING_OK)
+  {
+    return INVALID_SHARED_MEMORY;
+  }
+
+  int descriptor = shm_open(segment, O_RDONLY, 0);
+  if (descriptor < 0)
+  {
+    return INVALID_SHARED_MEMORY;
+  }
+  if (fstat(descriptor, &status) != 0 ||
+    status.st_size < (off_t)sizeof(SharedBoard))
+  {
+    close(descriptor);
+    return INVALID_SHARED_MEMORY;
+  }
+  void* memory = mmap(NULL, sizeof(SharedBoard), PROT_READ, MAP_SHARED,
+    descriptor, 0);
+  close(descriptor);
+  if (memory == MAP_FAILED)
+  {
+    return INVALID_SHARED_MEMORY;
+  }
+
+  *shared = (const SharedBoard*) memory;
+  unsigned int magic = (*shared)->magic_;
+  atomic_thread_fence(memory_order_acquire);
+  if (magic != PUBLISH_MAGIC || (*shared)->version_ != PUBLISH_VERSION)
+  {
+    subscriberClose(*shared);
+    return INVALID_SHARED_MEMORY;
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Unmaps a segment mapped by subscriberOpen
+///
+/// @param shared the mapping
+///
+//
+void subscriberClose(const SharedBoard* shared)
+{
+  munmap((void*)shared, sizeof(SharedBoard));
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Checks if the game that publishes a segment still runs. A game that was
+/// killed or crashed never clears running_ of its last snapshot.
+///
+/// @param shared the mapping
+///
+/// @return boolean data type true or false
+//
+bool writerAlive(const SharedBoard* shared)
+{
+  // EPERM means the process exists but belongs to another user
+  return kill(shared->writer_, 0) == 0 || errno != ESRCH;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Copies a consistent snapshot. Only every SPINS_PER_WRITER_CHECK failed
+/// attempts the game is looked up, because a game killed in the middle of a
+/// publish leaves the sequence odd forever.
+///
+/// @param shared the mapping
+/// @param snapshot snapshot to fill
+/// @param sequence pointer to store the sequence number of the snapshot
+/// @param retries incremented for every copy torn by the game
+///
+/// @return INVALID_SHARED_MEMORY if the game died while writing
+//
+ReturnValue readSnapshot(const SharedBoard* shared, BoardSnapshot* snapshot,
+  unsigned int* sequence, unsigned long long* retries)
+{
+  for (unsigned long long spins = 1; ; spins++)
+  {
+    if (spins % SPINS_PER_WRITER_CHECK == 0 && !writerAlive(shared))
+    {
+      return INVALID_SHARED_MEMORY;
+    }
+    unsigned int begin = atomic_load_explicit(&shared->sequence_,
+      memory_order_acquire);
+    if (begin % TWO != 0)
+    {
+      continue; // the game is writing right now
+    }
+    memcpy(snapshot, &shared->snapshot_, sizeof(BoardSnapshot));
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&shared->sequence_, memory_order_relaxed) ==
+      begin)
+    {
+      *sequence = begin;
+      return EVERYTHING_OK;
+    }
+    (*retries)++;
+  }
+}
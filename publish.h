@@ -0,0 +1,60 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#ifndef PUBLISH_H
+#define PUBLISH_H
+
+#include <stdatomic.h>
+#include <sys/types.h>
+
+#include "solver.h"
+
+#define PUBLISH_MAGIC 0x534F4C54U
+#define PUBLISH_VERSION 2
+#define PUBLISH_NAME_SIZE 256
+#define SPINS_PER_WRITER_CHECK 4096
+
+// State of the game after a command, copied as a whole by the readers
+typedef struct _BoardSnapshot_
+{
+  unsigned long long commands_;
+  int result_;
+  bool running_;
+  Board board_;
+} BoardSnapshot;
+
+// Layout of the shared memory segment. sequence_ is odd while the game
+// writes the snapshot, readers retry until they copied it between two equal
+// even values. writer_ is the process id of the game, so readers notice a
+// game that was killed before it could clear running_.
+typedef struct _SharedBoard_
+{
+  unsigned int magic_;
+  unsigned int version_;
+  pid_t writer_;
+  atomic_uint sequence_;
+  BoardSnapshot snapshot_;
+} SharedBoard;
+
+typedef struct _Publisher_
+{
+  SharedBoard* shared_;
+  BoardSnapshot snapshot_;
+  char name_[PUBLISH_NAME_SIZE];
+} Publisher;
+
+ReturnValue publisherOpen(Publisher* publisher, const char* name,
+  Doubly_Linked_List stacks[]);
+void publishCommand(Doubly_Linked_List stacks[], ReturnValue result,
+  void* context);
+void publisherClose(Publisher* publisher);
+
+ReturnValue subscriberOpen(const char* name, const SharedBoard** shared);
+void subscriberClose(const SharedBoard* shared);
+bool writerAlive(const SharedBoard* shared);
+ReturnValue readSnapshot(const SharedBoard* shared, BoardSnapshot* snapshot,
+  unsigned int* sequence, unsigned long long* retries);
+
+#endif // PUBLISH_H
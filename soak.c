@@ -0,0 +1,510 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+// Soak harness for the gameloop. Plays seeded deals through playGame with
+// generated valid and invalid commands and reports the throughput, the peak
+// resident memory and the allocations of the game over time. It fails if
+// the throughput drops or memory grows. Must be linked with
+// -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free.
+//
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "solitaire.h"
+#include "solver.h"
+#include "util.h"
+
+#define DEFAULT_COMMANDS 2000000LL
+#define DEFAULT_REPORT_EVERY 200000LL
+#define DEFAULT_SEED 1ULL
+#define DEFAULT_MAX_SLOWDOWN 50
+#define DEFAULT_MAX_RSS_GROWTH_KB 4096L
+#define COMMANDS_PER_GAME 400
+#define WARMUP_WINDOWS 1
+#define LINE_SIZE 4096
+#define MAX_LONG_LINE 3000
+#define DEAL_TEXT_SIZE 512
+#define PERCENT 100
+
+// After a NEXT n the harness sends single NEXT commands, first until the
+// draw stack is back where it started and then n more, which must end on the
+// board NEXT n left.
+typedef struct _NextCheck_
+{
+  Board start_;
+  Board after_;
+  int count_;
+  int rewind_;
+  int sent_;
+  long long mismatches_;
+} NextCheck;
+
+typedef struct _Soak_
+{
+  Doubly_Linked_List* stacks_;
+  unsigned long long random_;
+  char line_[LINE_SIZE];
+  int line_length_;
+  int line_position_;
+  long long commands_;
+  int game_commands_;
+  NextCheck next_check_;
+} Soak;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+void __real_free(void* pointer);
+
+static unsigned long long allocations;
+static long long live_allocations;
+
+static unsigned long long nextRandom(Soak* soak);
+static void generateCommand(Soak* soak);
+static void startNextCheck(Soak* soak, int count);
+static bool continueNextCheck(Soak* soak);
+static ssize_t readCommands(void* cookie, char* buffer, size_t size);
+static ReturnValue dealGame(Soak* soak, Doubly_Linked_List stacks[]);
+static long peakRss(void);
+
+//-----------------------------------------------------------------------------
+///
+/// Counting wrappers around the allocator
+///
+//
+void* __wrap_malloc(size_t size)
+{
+  allocations++;
+  live_allocations++;
+  return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size)
+{
+  allocations++;
+  live_allocations++;
+  return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* pointer, size_t size)
+{
+  allocations++;
+  if (pointer == NULL)
+  {
+    live_allocations++;
+  }
+  return __real_realloc(pointer, size);
+}
+
+void __wrap_free(void* pointer)
+{
+  if (pointer != NULL)
+  {
+    live_allocations--;
+  }
+  __real_free(pointer);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// The soak harness
+///
+/// @param argc number of arguments
+/// @param argv [--commands N] [--seed N] [--report-every N]
+///             [--max-slowdown PERCENT] [--max-rss-growth KB]
+///
+/// @return 0 if throughput and memory stayed stable, 1 otherwise
+//
+int main(int argc, char* argv[])
+{
+  long long total_commands = DEFAULT_COMMANDS;
+  long long report_every = DEFAULT_REPORT_EVERY;
+  unsigned long long seed = DEFAULT_SEED;
+  int max_slowdown = DEFAULT_MAX_SLOWDOWN;
+  long max_rss_growth = DEFAULT_MAX_RSS_GROWTH_KB;
+
+  Option known[] = {
+    { "--commands", OPTION_LONG_LONG, &total_commands },
+    { "--seed", OPTION_UNSIGNED, &seed },
+    { "--report-every", OPTION_LONG_LONG, &report_every },
+    { "--max-slowdown", OPTION_INT, &max_slowdown },
+    { "--max-rss-growth", OPTION_LONG, &max_rss_growth } };
+  if (parseOptions(argc, argv, 1, known, sizeof(known) / sizeof(known[0])) !=
+    EVERYTHING_OK || total_commands < 1 || report_every < 1)
+  {
+    fprintf(stderr, "Usage: ./soak [--commands N] [--seed N] "
+      "[--report-every N] [--max-slowdown PERCENT] [--max-rss-growth KB]\n");
+    return 1;
+  }
+
+  // The board is printed after every command, only the reports are wanted
+  if (freopen("/dev/null", "w", stdout) == NULL)
+  {
+    return 1;
+  }
+
+  Soak soak;
+  memset(&soak, 0, sizeof(Soak));
+  soak.random_ = seed == 0 ? 1 : seed;
+  cookie_io_functions_t functions = { readCommands, NULL, NULL, NULL };
+  long long baseline_allocations = live_allocations;
+  long long next_report = report_every;
+  double reference_rate = 0;
+  long reference_rss = 0;
+  int window = 0;
+  int games = 0;
+  bool failed = false;
+  struct timespec window_start;
+  clock_gettime(CLOCK_MONOTONIC, &window_start);
+  long long window_commands = 0;
+
+  while (soak.commands_ < total_commands && !failed)
+  {
+    Doubly_Linked_List stacks[NUMBER_OF_STACKS] = { NULL };
+    if (dealGame(&soak, stacks) != EVERYTHING_OK)
+    {
+      fprintf(stderr, "[ERR] Could not deal game %d\n", games);
+      return 1;
+    }
+    soak.stacks_ = stacks;
+    soak.game_commands_ = 0;
+    soak.next_check_.count_ = 0;
+    soak.line_length_ = 0;
+    soak.line_position_ = 0;
+
+    FILE* input = fopencookie(&soak, "r", functions);
+    if (input == NULL)
+    {
+      deleteStacks(stacks);
+      return 1;
+    }
+    // Unbuffered, so every command is generated after the previous one ran
+    setvbuf(input, NULL, _IONBF, 0);
+    ReturnValue return_value = playGame(stacks, input, NULL, NULL);
+    fclose(input);
+    deleteStacks(stacks);
+    games++;
+
+    if (return_value != EVERYTHING_OK)
+    {
+      fprintf(stderr, "[ERR] Game %d ended with %d\n", games, return_value);
+      failed = true;
+    }
+    if (soak.next_check_.mismatches_ != 0)
+    {
+      fprintf(stderr, "[ERR] NEXT n and n NEXT commands differed %lld times "
+        "in game %d\n", soak.next_check_.mismatches_, games);
+      soak.next_check_.mismatches_ = 0;
+      failed = true;
+    }
+    if (live_allocations != baseline_allocations)
+    {
+      fprintf(stderr, "[ERR] %lld allocations leaked by game %d\n",
+        live_allocations - baseline_allocations, games);
+      failed = true;
+    }
+
+    if (soak.commands_ >= next_report || soak.commands_ >= total_commands)
+    {
+      double seconds = secondsSince(&window_start);
+      double rate = (soak.commands_ - window_commands) / seconds;
+      long rss = peakRss();
+      fprintf(stderr, "commands %lld  games %d  %.0f commands/s  "
+        "peak RSS %ld KB  allocations %llu (%lld live)\n", soak.commands_,
+        games, rate, rss, allocations, live_allocations);
+
+      if (window == WARMUP_WINDOWS)
+      {
+        reference_rate = rate;
+        reference_rss = rss;
+      }
+      else if (window > WARMUP_WINDOWS)
+      {
+        if (rate * PERCENT < reference_rate * (PERCENT - max_slowdown))
+        {
+          fprintf(stderr, "[ERR] Throughput dropped from %.0f to %.0f "
+            "commands/s\n", reference_rate, rate);
+          failed = true;
+        }
+        if (rss - reference_rss > max_rss_growth)
+        {
+          fprintf(stderr, "[ERR] Peak RSS grew by %ld KB\n",
+            rss - reference_rss);
+          failed = true;
+        }
+      }
+      window++;
+      next_report += report_every;
+      window_commands = soak.commands_;
+      clock_gettime(CLOCK_MONOTONIC, &window_start);
+    }
+  }
+
+  fprintf(stderr, "%s after %lld commands in %d games\n",
+    failed ? "FAILED" : "PASSED", soak.commands_, games);
+  return failed ? 1 : 0;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Steps the xorshift generator of the harness
+///
+/// @param soak harness state
+///
+/// @return next random number
+//
+static unsigned long long nextRandom(Soak* soak)
+{
+  soak->random_ ^= soak->random_ << 13;
+  soak->random_ ^= soak->random_ >> 7;
+  soak->random_ ^= soak->random_ << 17;
+  return soak->random_;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Shuffles a deal, writes it in the config format and reads it with
+/// readConfig, then arranges the cards like the game does
+///
+/// @param soak harness state
+/// @param stacks array struct of the doubly linked list
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue dealGame(Soak* soak, Doubly_Linked_List stacks[])
+{
+  int cards[NUMBER_OF_CARDS];
+  char text[DEAL_TEXT_SIZE];
+  int length = 0;
+
+  for (int card = 0; card < NUMBER_OF_CARDS; card++)
+  {
+    cards[card] = card;
+  }
+  for (int card = NUMBER_OF_CARDS - 1; card > 0; card--)
+  {
+    int other = nextRandom(soak) % (card + 1);
+    int swap = cards[card];
+    cards[card] = cards[other];
+    cards[other] = swap;
+  }
+  for (int card = 0; card < NUMBER_OF_CARDS; card++)
+  {
+    length += snprintf(text + length, DEAL_TEXT_SIZE - length, "%s %s\n",
+      cards[card] % TWO == 0 ? "BLACK" : "RED", rankName(cards[card]));
+  }
+
+  FILE* file = fmemopen(text, length, "r");
+  if (file == NULL)
+  {
+    return INVALID_FILE;
+  }
+  ReturnValue return_value = readConfig(file, &stacks[DRAWSTACK]);
+  fclose(file);
+  if (return_value == EVERYTHING_OK)
+  {
+    arrangeCards(stacks);
+  }
+  return return_value;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Writes the next command into the line buffer. About half of the commands
+/// are legal moves, the rest are invalid moves, unknown or malformed
+/// commands and overlong lines. Every game ends with EXIT.
+///
+/// @param soak harness state
+///
+//
+static void generateCommand(Soak* soak)
+{
+  char* garbage[] = { "HELP", "HELP ME", "MOVE", "MOVE RED", "MOVE RED 5 TO",
+    "move black k to 1", "NEXT NEXT", "  MOVE   RED  A  TO  5  ", "EXITS",
+    "MOVE RED 5 TO 3 NOW", "MOVE GREEN 5 TO 3", "MOVE RED 5 ON 3", "",
+    "MOVE RED 5 TO 9", "MOVE BLACK 11 TO 2", "NEXT 0", "NEXT -3", "NEXT 3 4",
+    "NEXT 2x" };
+  int garbage_count = sizeof(garbage) / sizeof(garbage[0]);
+  int length = 0;
+  unsigned long long kind = nextRandom(soak) % PERCENT;
+
+  if (soak->game_commands_ >= COMMANDS_PER_GAME)
+  {
+    length = snprintf(soak->line_, LINE_SIZE, "EXIT\n");
+  }
+  else if (continueNextCheck(soak))
+  {
+    length = snprintf(soak->line_, LINE_SIZE, "NEXT\n");
+  }
+  else if (kind < 50)
+  {
+    Board board;
+    Move moves[MAX_MOVES];
+    boardFromStacks(&board, soak->stacks_);
+    int count = generateMoves(&board, moves);
+    Move move = { 1, DRAWSTACK };
+    if (count > 0)
+    {
+      move = moves[nextRandom(soak) % count];
+    }
+    if (move.target_stack_ == DRAWSTACK)
+    {
+      length = snprintf(soak->line_, LINE_SIZE, "NEXT\n");
+    }
+    else
+    {
+      length = snprintf(soak->line_, LINE_SIZE, "MOVE %s %s TO %d\n",
+        move.card_ % TWO == 0 ? "BLACK" : "RED", rankName(move.card_),
+        move.target_stack_);
+    }
+  }
+  else if (kind < 55)
+  {
+    length = snprintf(soak->line_, LINE_SIZE, "NEXT\n");
+  }
+  else if (kind < 60)
+  {
+    int count = (int)(nextRandom(soak) % (NUMBER_OF_CARDS * TWO)) + 1;
+    startNextCheck(soak, count);
+    length = snprintf(soak->line_, LINE_SIZE, "NEXT %d\n", count);
+  }
+  else if (kind < 80)
+  {
+    int card = nextRandom(soak) % NUMBER_OF_CARDS;
+    length = snprintf(soak->line_, LINE_SIZE, "MOVE %s %s TO %d\n",
+      card % TWO == 0 ? "BLACK" : "RED", rankName(card),
+      (int)(nextRandom(soak) % (NUMBER_OF_STACKS + 1)));
+  }
+  else if (kind < 95)
+  {
+    length = snprintf(soak->line_, LINE_SIZE, "%s\n",
+      garbage[nextRandom(soak) % garbage_count]);
+  }
+  else
+  {
+    int long_length = nextRandom(soak) % MAX_LONG_LINE;
+    for (; length < long_length; length++)
+    {
+      soak->line_[length] = nextRandom(soak) % 4 == 0 ? ' ' :
+        'A' + nextRandom(soak) % 26;
+    }
+    soak->line_[length++] = '\n';
+  }
+
+  soak->line_length_ = length;
+  soak->line_position_ = 0;
+  soak->game_commands_++;
+  soak->commands_++;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Remembers the board before a NEXT n, so the following commands can
+/// compare it with single NEXT commands
+///
+/// @param soak harness state
+/// @param count n of the NEXT n command
+///
+//
+static void startNextCheck(Soak* soak, int count)
+{
+  NextCheck* check = &soak->next_check_;
+  boardFromStacks(&check->start_, soak->stacks_);
+  int size = check->start_.size_[DRAWSTACK];
+  check->count_ = size < TWO ? 0 : count;
+  check->rewind_ = size < TWO ? 0 : (size - count % size) % size;
+  check->sent_ = -1;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Checks the board the last command left while comparing NEXT n with single
+/// NEXT commands. Only the tail of the draw stack may be faced up.
+///
+/// @param soak harness state
+///
+/// @return true if another single NEXT has to be sent
+//
+static bool continueNextCheck(Soak* soak)
+{
+  NextCheck* check = &soak->next_check_;
+  if (check->count_ == 0)
+  {
+    return false;
+  }
+  Board board;
+  boardFromStacks(&board, soak->stacks_);
+  if (check->sent_ < 0)
+  {
+    check->after_ = board;
+    check->sent_ = 0;
+  }
+  for (Node* node = soak->stacks_[DRAWSTACK].head_; node != NULL;
+    node = node->next_)
+  {
+    if (node->is_faced_up_ != (node->next_ == NULL))
+    {
+      check->mismatches_++;
+    }
+  }
+  if ((check->sent_ == check->rewind_ &&
+    memcmp(&board, &check->start_, sizeof(Board)) != 0) ||
+    (check->sent_ == check->rewind_ + check->count_ &&
+    memcmp(&board, &check->after_, sizeof(Board)) != 0))
+  {
+    check->mismatches_++;
+  }
+  if (check->sent_ == check->rewind_ + check->count_)
+  {
+    check->count_ = 0;
+    return false;
+  }
+  check->sent_++;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Read function of the command stream handed to playGame
+///
+/// @param cookie harness state
+/// @param buffer buffer to fill
+/// @param size size of the buffer
+///
+/// @return number of bytes read
+//
+static ssize_t readCommands(void* cookie, char* buffer, size_t size)
+{
+  Soak* soak = (Soak*) cookie;
+  if (soak->line_position_ == soak->line_length_)
+  {
+    generateCommand(soak);
+  }
+  size_t count = soak->line_length_ - soak->line_position_;
+  if (count > size)
+  {
+    count = size;
+  }
+  memcpy(buffer, soak->line_ + soak->line_position_, count);
+  soak->line_position_ += count;
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Reads the peak resident set size of the process
+///
+/// @return peak RSS in KB
+//
+static long peakRss(void)
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
@@ -9,161 +9,66 @@
 #include <ctype.h>
 #include <stdbool.h>
 
-#define NUMBER_OF_STACKS 7
-#define NUMBER_OF_GAMESTACKS 4
-#define NUMBER_OF_CARDFACES 2
-#define BOARD_SIZE 16
-#define MAX_COMMAND_ARG 5
-#define QUIT_GAME_ERRORS -4
-#define DRAWSTACK 0
-
-// Memory allocation
-#define SIZE 20
-#define TWO 2
-
-#define WHITESPACE 32
-#define BLACK_KING 24
-
-#define DEPOSIT_STACK_1 5
-#define DEPOSIT_STACK_2 6
-
-// Commands
-#define COMMAND_TYPE 0
-#define COMMAND_FIRST_ARG 1
-#define MOVE_CARD_COLOR 1
-#define MOVE_CARD_RANK 2
-#define MOVE_TO 3
-#define MOVE_TARGET_STACK 4
-
-// Struct defines values for cards and are used for creating a
-// doubly linked list
-typedef struct Node
-{
-  int card_value_;
-  bool is_faced_up_;
-  struct Node* next_;
-  struct Node* prev_;
-}Node;
-
-typedef struct _Doubly_Linked_List_
-{
-  Node* head_;
-  Node* tail_;
-}Doubly_Linked_List;
-
-// Return values of the program
-typedef enum _ReturnValue_
-{
-  MOVED = 2,
-  EXIT_GAME = 1,
-  EVERYTHING_OK = 0,
-  INVALID_MOVE_COMMAND = -1,
-  INVALID_COMMAND = -2,
-  INVALID_CARD = -3,
-  INVALID_ARG_COUNT = -4,
-  INVALID_FILE = -5,
-  OUT_OF_MEMORY = -6,
-  UNIDENTIFIED_ERROR = -7
-} ReturnValue;
-
-// Forward declarations
-ReturnValue printErrorMessage(ReturnValue return_value);
-void append(Doubly_Linked_List* list_ref, int card, bool isDrawstack);
-void push(Doubly_Linked_List* list_ref, int card);
-int pop(Doubly_Linked_List* list_ref);
-void rotateDrawstack(Doubly_Linked_List* drawstack);
-void arrangeCards(Doubly_Linked_List stacks[]);
-Node* newNode(int card_value);
-ReturnValue readConfig(FILE* file, Doubly_Linked_List* draw_stack);
-void printGame(Doubly_Linked_List stacks[]);
-void printCard(Node* card);
-ReturnValue readInput(char** user_input, int* size);
-ReturnValue handleCommand(Doubly_Linked_List stacks[], char* user_input);
-ReturnValue printHelp(char* command[]);
-ReturnValue moveCommand(Doubly_Linked_List stacks[], char* command[]);
-bool checkMove(Doubly_Linked_List stacks[], int target_card, int target_stack,
-   int* target_card_index, int* target_card_stack);
-bool searchCard(Doubly_Linked_List stacks[], int target_card,
-   int* target_card_index, int* target_card_stack);
-bool twoCardsInOrder(int bottom_card, int top_card, int target_stack);
-bool checkOrder(Doubly_Linked_List stack, int target_card_index,
-   int target_stack);
-void deleteStacks(Doubly_Linked_List stacks[]);
-ReturnValue strToCard(char* color, char* rank, int* card);
-ReturnValue splitString(char* string, char* arguments[]);
-ReturnValue move(Doubly_Linked_List stacks[], int target_stack,
-  int target_card_index, int target_card_stack);
+#include "solitaire.h"
+#include "util.h"
 
 //-----------------------------------------------------------------------------
 ///
-/// The main program
-/// Checks for file and starts the gameloop
+/// Runs the gameloop until the game is won, exited or the input ends
 ///
-/// @param argc number of arguments
-/// @param argv program arguments
+/// @param stacks array struct of the doubly linked list
+/// @param input stream to read the commands from
+/// @param observer called after every command, may be NULL
+/// @param context passed to the observer
 ///
-/// @return value of ReturnValue which defines type of error
+/// @return EVERYTHING_OK, or the error that ended the game unprinted
 //
-int main(int argc, char* argv[]) {
-
-  if (argc != 2)
-  {
-  	return printErrorMessage(INVALID_ARG_COUNT);
-  }
-
-  Doubly_Linked_List stacks[NUMBER_OF_STACKS] = { NULL };
-
-  FILE* file = fopen(argv[1], "r");
-  if (file == NULL)
-  {
-    return printErrorMessage(INVALID_FILE);
-  }
-
-  ReturnValue return_value = readConfig(file, &stacks[0]);
-  if(return_value != EVERYTHING_OK)
-  {
-    deleteStacks(stacks);
-    return printErrorMessage(return_value);
-  }
-  fclose(file);
-
-  arrangeCards(stacks);
-
-  printGame(stacks);
+ReturnValue playGame(Doubly_Linked_List stacks[], FILE* input,
+  CommandObserver observer, void* context)
+{
+  ReturnValue return_value;
+  ReturnValue game_error = EVERYTHING_OK;
   char* user_input = (char*) malloc(SIZE);
   int size = SIZE;
   if (user_input == NULL)
   {
-    return printErrorMessage(OUT_OF_MEMORY);
+    return OUT_OF_MEMORY;
   }
 
   while (true) // Starts gameloop
   {
-    return_value = readInput(&user_input, &size);
+    return_value = readInput(input, &user_input, &size);
+    if (return_value == EXIT_GAME) // input has ended
+    {
+      break;
+    }
     if (return_value != EVERYTHING_OK)
     {
-      printErrorMessage(return_value);
+      game_error = return_value;
       break;
     }
     return_value = handleCommand(stacks, user_input);
+    if (observer != NULL)
+    {
+      observer(stacks, return_value, context);
+    }
 
+    // quit game if error is a quitgameerror, the caller reports it
+    if (return_value <= QUIT_GAME_ERRORS)
+    {
+      game_error = return_value;
+      break;
+    }
     if (return_value < EVERYTHING_OK) //error values are negative
     {
       printErrorMessage(return_value);
-      // quit game if error is a quitgameerror
-      if (return_value <= QUIT_GAME_ERRORS) 
-      {
-        break;
-      }
     }
 
     if (return_value == MOVED) // A valid command has been executed
     {
       printGame(stacks);
 
-      if ((stacks[DEPOSIT_STACK_1].tail_ != NULL && stacks[DEPOSIT_STACK_2].tail_
-         != NULL) && stacks[DEPOSIT_STACK_1].tail_->card_value_ +
-         stacks[DEPOSIT_STACK_2].tail_->card_value_ == 49)
+      if (isGameWon(stacks))
       {
         printErrorMessage(return_value);
         break;
@@ -174,23 +79,67 @@ int main(int argc, char* argv[]) {
       break;
     }
   }
-  
+
   free(user_input);
   user_input = NULL;
-  deleteStacks(stacks);
-  return EVERYTHING_OK;
+  return game_error;
 }
 
 //-----------------------------------------------------------------------------
 ///
-/// Rotate the drawstack
+/// Checks if both kings lie on the deposit stacks
+///
+/// @param stacks array struct of the doubly linked list
+///
+/// @return boolean data type true or false
+//
+bool isGameWon(Doubly_Linked_List stacks[])
+{
+  return stacks[DEPOSIT_STACK_1].tail_ != NULL &&
+    stacks[DEPOSIT_STACK_2].tail_ != NULL &&
+    stacks[DEPOSIT_STACK_1].tail_->card_value_ +
+    stacks[DEPOSIT_STACK_2].tail_->card_value_ == WINNING_DEPOSIT_SUM;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Rotate the drawstack count times, every time the top card goes to the
+/// bottom. The top cards are relinked below the head in one splice, so no
+/// node is freed or allocated. Counting the cards and finding the new tail
+/// still walks the list, a rotation takes O(cards) steps whatever count is.
+/// Draw stacks with less than two cards stay unchanged.
 ///
 /// @param drawstack struct of the doubly linked list
+/// @param count number of rotations
 ///
 //
-void rotateDrawstack(Doubly_Linked_List* drawstack)
+void rotateDrawstack(Doubly_Linked_List* drawstack, int count)
 {
-  push(drawstack, pop(drawstack));
+  int size = 0;
+  for (Node* node = drawstack->head_; node != NULL; node = node->next_)
+  {
+    size++;
+  }
+  if (size < TWO || count < 1 || count % size == 0)
+  {
+    return;
+  }
+  count %= size;
+
+  Node* first = drawstack->tail_;
+  for (int index = 1; index < count; index++)
+  {
+    first = first->prev_;
+  }
+  Node* new_tail = first->prev_;
+  drawstack->tail_->is_faced_up_ = false;
+  drawstack->tail_->next_ = drawstack->head_;
+  drawstack->head_->prev_ = drawstack->tail_;
+  first->prev_ = NULL;
+  new_tail->next_ = NULL;
+  new_tail->is_faced_up_ = true;
+  drawstack->head_ = first;
+  drawstack->tail_ = new_tail;
 }
 
 //-----------------------------------------------------------------------------
@@ -431,11 +380,9 @@ ReturnValue moveCommand(Doubly_Linked_List stacks[], char* command[])
   }
 
   int target_card = 0;
-  int target_card_index;
-  int target_card_stack;
   int target_stack = strtol(command[MOVE_TARGET_STACK], NULL, 10);
 
-  if (target_stack < 1 || NUMBER_OF_STACKS < target_stack)
+  if (target_stack < 1 || NUMBER_OF_STACKS <= target_stack)
   {
     return INVALID_COMMAND;
   }
@@ -445,6 +392,59 @@ ReturnValue moveCommand(Doubly_Linked_List stacks[], char* command[])
   {
     return return_value;
   }
+  return moveCard(stacks, target_card, target_stack);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Checks the NEXT command and its optional count and rotates the drawstack
+///
+/// @param stacks array struct of the doubly linked list
+/// @param command splitted user input, NEXT [count]
+///
+/// @return MOVED or a value to evaluate the occurrence of an error
+//
+ReturnValue nextCommand(Doubly_Linked_List stacks[], char* command[])
+{
+  long count = 1;
+  if (command[COMMAND_FIRST_ARG] != NULL)
+  {
+    char* end = NULL;
+    count = strtol(command[COMMAND_FIRST_ARG], &end, 10);
+    if (*end != '\0' || count < 1 || MAX_NEXT_COUNT < count ||
+      command[COMMAND_FIRST_ARG + 1] != NULL)
+    {
+      return INVALID_COMMAND;
+    }
+  }
+  rotateDrawstack(&stacks[DRAWSTACK], (int)count);
+  return MOVED;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Moves a face up card and all cards on top of it to a stack
+///
+/// @param stacks array struct of the doubly linked list
+/// @param target_card card to move
+/// @param target_stack stack to move the card to
+///
+/// @return MOVED or a value to evaluate the occurrence of an error
+//
+ReturnValue moveCard(Doubly_Linked_List stacks[], int target_card,
+  int target_stack)
+{
+  int target_card_index;
+  int target_card_stack;
+
+  if (target_stack < 1 || NUMBER_OF_STACKS <= target_stack)
+  {
+    return INVALID_COMMAND;
+  }
+  if (target_card < 0 || NUMBER_OF_CARDS <= target_card)
+  {
+    return INVALID_CARD;
+  }
 
   bool move_valid = checkMove(stacks, target_card, target_stack,
     &target_card_index, &target_card_stack);
@@ -477,6 +477,7 @@ ReturnValue handleCommand(Doubly_Linked_List stacks[], char* user_input)
   char* exit_game = "EXIT";
   char* move = "MOVE";
   char* next = "NEXT";
+  char* hint = "HINT";
 
   char* command[MAX_COMMAND_ARG];
   if (splitString(user_input, command) != EVERYTHING_OK) 
@@ -493,8 +494,11 @@ ReturnValue handleCommand(Doubly_Linked_List stacks[], char* user_input)
   }
   else if (strcmp(command[COMMAND_TYPE], next) == 0)
   {
-    rotateDrawstack(&stacks[DRAWSTACK]);
-    return MOVED;
+    return nextCommand(stacks, command);
+  }
+  else if (strcmp(command[COMMAND_TYPE], hint) == 0)
+  {
+    return command[COMMAND_FIRST_ARG] == NULL ? SHOW_HINT : INVALID_COMMAND;
   }
   else if (strcmp(command[COMMAND_TYPE], help) == 0)
   {
@@ -518,12 +522,13 @@ ReturnValue handleCommand(Doubly_Linked_List stacks[], char* user_input)
 //
 ReturnValue splitString(char* string, char* arguments[])
 {
-  arguments[0] = strtok(string, " ");
+  char* position = NULL;
+  arguments[0] = strtok_r(string, " ", &position);
   for (int index = 1; index < MAX_COMMAND_ARG; index++)
   {
-    arguments[index] = strtok(NULL, " ");
+    arguments[index] = strtok_r(NULL, " ", &position);
   }
-  if (strtok(NULL, " ") != NULL)
+  if (strtok_r(NULL, " ", &position) != NULL)
   {
     return INVALID_COMMAND; // more arguments then allowed
   }
@@ -535,13 +540,16 @@ ReturnValue splitString(char* string, char* arguments[])
 /// Reads input and filters unnecessary whitespaces. Reallocates memory if
 /// more is needed
 ///
+/// @param input stream to read from
 /// @param user_input pointer to an allocated user input string
+/// @param size pointer to the size of the allocated user input string
 ///
-/// @return value to evaluate the occurrence of an error
+/// @return value to evaluate the occurrence of an error, EXIT_GAME if the
+/// input has ended
 //
-ReturnValue readInput(char** user_input, int* size)
+ReturnValue readInput(FILE* input, char** user_input, int* size)
 {
-  char text = 0;
+  int text = 0;
   int index = 0;
   int whitespace_flag = 0;
 
@@ -550,28 +558,21 @@ ReturnValue readInput(char** user_input, int* size)
   {
     return OUT_OF_MEMORY;
   }
-  while ((text = toupper(getchar())) != '\n' && text != EOF)
+  while ((text = toupper(getc(input))) != '\n' && text != EOF)
   {
-    if (index < *size)
+    if (text == WHITESPACE)
     {
-      if (text == WHITESPACE)
+      if (whitespace_flag)
       {
-        if (whitespace_flag)
-        {
-          continue;
-        }
-        whitespace_flag = 1;
-        (*user_input)[index] = text;
-        index++;
-      }
-      else
-      {
-        (*user_input)[index] = text;
-        index++;
-        whitespace_flag = 0;
+        continue;
       }
+      whitespace_flag = 1;
     }
     else
+    {
+      whitespace_flag = 0;
+    }
+    if (index + 1 >= *size) // keep room for the terminating zero
     {
       *size *= TWO;
       char* tmp = *user_input;
@@ -581,11 +582,15 @@ ReturnValue readInput(char** user_input, int* size)
         free(tmp);
         return OUT_OF_MEMORY;
       }
-      (*user_input)[index] = text;
-      index++;
     }
+    (*user_input)[index] = text;
+    index++;
   }
   (*user_input)[index] = '\0';
+  if (text == EOF && index == 0)
+  {
+    return EXIT_GAME;
+  }
   return EVERYTHING_OK;
 }
 
@@ -603,6 +608,8 @@ ReturnValue printHelp(char* command[])
   {
     printf("possible command:\n");
     printf(" - move <color> <value> to <stacknumber>\n");
+    printf(" - next [count]\n");
+    printf(" - hint\n");
     printf(" - help\n");
     printf(" - exit\n");
     return EVERYTHING_OK;
@@ -613,7 +620,8 @@ ReturnValue printHelp(char* command[])
 //-----------------------------------------------------------------------------
 ///
 /// Follows the doubly linked list to specific fields and calls for further
-/// functions
+/// functions. The nodes are relinked from the draw stack onto the game
+/// stacks, so dealing never allocates.
 ///
 /// @param stacks array struct of the doubly linked list
 ///
@@ -624,7 +632,32 @@ void arrangeCards(Doubly_Linked_List stacks[])
   {
     for (int col = row ; col < NUMBER_OF_GAMESTACKS + 1 ; col++)
     {
-      append(&stacks[col], pop(&stacks[0]),false);
+      Node* node = stacks[0].tail_;
+      if (node == NULL)
+      {
+        return;
+      }
+      stacks[0].tail_ = node->prev_;
+      if (stacks[0].tail_ != NULL)
+      {
+        stacks[0].tail_->next_ = NULL;
+        stacks[0].tail_->is_faced_up_ = true;
+      }
+      else
+      {
+        stacks[0].head_ = NULL;
+      }
+      node->prev_ = stacks[col].tail_;
+      node->is_faced_up_ = true;
+      if (stacks[col].tail_ != NULL)
+      {
+        stacks[col].tail_->next_ = node;
+      }
+      else
+      {
+        stacks[col].head_ = node;
+      }
+      stacks[col].tail_ = node;
     }
   }
 }
@@ -680,13 +713,11 @@ void printGame(Doubly_Linked_List stacks[])
 //
 void printCard(Node* card)
 {
-  char* ranks[] = { "A", "2", "3", "4", "5", "6", "7", "8", "9", "10", "J",
-   "Q", "K" };
   char color[] = { 'B', 'R' };
 
   if (card->is_faced_up_)
   {
-    printf("%c%-2s", color[card->card_value_ % 2], ranks[card->card_value_ / 2]);
+    printf("%c%-2s", color[card->card_value_ % 2], rankName(card->card_value_));
   }
   else
   {
@@ -730,6 +761,29 @@ ReturnValue printErrorMessage(ReturnValue return_value)
   case UNIDENTIFIED_ERROR:
     printf("[ERR] Unidentified error!\n");
     break;
+  case INVALID_CHECKPOINT:
+    printf("[ERR] Invalid checkpoint!\n");
+    return_value = 4;
+    break;
+  case INVALID_SHARED_MEMORY:
+    printf("[ERR] Invalid shared memory!\n");
+    return_value = 5;
+    break;
+  case INVALID_TABLEBASE:
+    printf("[ERR] Invalid tablebase!\n");
+    return_value = 6;
+    break;
+  case SHARED_MEMORY_IN_USE:
+    printf("[ERR] Shared memory is in use by another game!\n");
+    return_value = 7;
+    break;
+  case DUPLICATE_CARD:
+    printf("[ERR] Duplicate card!\n");
+    return_value = 3;
+    break;
+  case SHOW_HINT:
+    //left blank intentionally
+    break;
   case MOVED:
     //left blank intentionally
     break;
@@ -755,23 +809,21 @@ ReturnValue printErrorMessage(ReturnValue return_value)
 //
 ReturnValue strToCard(char* color, char* rank, int* card)
 {
-  char* ranks[] = { "A", "2", "3", "4", "5", "6", "7", "8", "9", "10", "J",
-   "Q", "K" };
 
   if (strcmp(color, "BLACK") != 0 && strcmp(color, "RED") != 0)
   {
     return INVALID_COMMAND;
   }
 
-  for (int index = 0; index < 13; index++)
+  for (int index = 0; index < NUMBER_OF_RANKS; index++)
   {
-    if (strcmp(ranks[index], rank) == 0)
+    if (strcmp(rankName(index * TWO), rank) == 0)
     {
       *card = (index * 2) + (strcmp(color, "BLACK") == 0 ? 0 : 1);
-      break;
+      return EVERYTHING_OK;
     }
   }
-  return EVERYTHING_OK;
+  return INVALID_CARD;
 }
 
 //-----------------------------------------------------------------------------
@@ -785,10 +837,12 @@ ReturnValue strToCard(char* color, char* rank, int* card)
 //
 ReturnValue readCard(FILE* file, int* card)
 {
-  char color[6];
-  char rank[3];
+  char color[8];
+  char rank[4];
 
-  if (fscanf(file, " %s %s", color, rank) != 2)
+  // The buffers hold longer words than any color and rank, so a word cut
+  // to the buffer size never matches a card
+  if (fscanf(file, " %7s %3s", color, rank) != 2)
   {
     return INVALID_FILE;
   }
@@ -797,36 +851,58 @@ ReturnValue readCard(FILE* file, int* card)
 
 //-----------------------------------------------------------------------------
 ///
-/// Checks input of a configuration file
+/// Reads the cards of one deal into the draw stack. Every card has to be
+/// given once.
 ///
 /// @param file pointer to file to read from
 /// @param draw_stack struct of the doubly linked list
 ///
-/// @return value to evaluate the occurrence of an error
+/// @return value to evaluate the occurrence of an error, DUPLICATE_CARD for
+///         a card given twice
 //
-ReturnValue readConfig(FILE* file, Doubly_Linked_List* draw_stack)
+ReturnValue readDeal(FILE* file, Doubly_Linked_List* draw_stack)
 {
-  int checkArray[26] = { 0 };
+  int checkArray[NUMBER_OF_CARDS] = { 0 };
   ReturnValue read_error;
   int card;
 
-  for (int index = 0; index < 26; index++)
+  for (int index = 0; index < NUMBER_OF_CARDS; index++)
   {
     if ((read_error = readCard(file, &card)) != EVERYTHING_OK)
     {
       return INVALID_FILE;
     }
-    if (checkArray[card] == 0)
+    if (checkArray[card] != 0)
     {
-      //checkArray[card]++;
-      append(draw_stack, card++, true);
+      return DUPLICATE_CARD;
     }
-    else
+    checkArray[card]++;
+    if (append(draw_stack, card, true) != EVERYTHING_OK)
     {
-    printf("NICE");
-      return INVALID_FILE;
+      return OUT_OF_MEMORY;
     }
   }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Checks input of a configuration file
+///
+/// @param file pointer to file to read from
+/// @param draw_stack struct of the doubly linked list
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue readConfig(FILE* file, Doubly_Linked_List* draw_stack)
+{
+  int card;
+  ReturnValue return_value = readDeal(file, draw_stack);
+
+  if (return_value != EVERYTHING_OK)
+  {
+    return return_value;
+  }
 
   if (readCard(file, &card) == EVERYTHING_OK)
   {
@@ -847,7 +923,7 @@ int pop(Doubly_Linked_List* list_ref)
 {
   if (list_ref->tail_ == NULL)
   {
-    return 0;
+    return NO_CARD;
   }
   int card_value = list_ref->tail_->card_value_;
   Node* prev = list_ref->tail_->prev_;
@@ -873,15 +949,20 @@ int pop(Doubly_Linked_List* list_ref)
 /// @param list_ref struct of the doubly linked list
 /// @param card defines the card to add
 ///
+/// @return value to evaluate the occurrence of an error
 //
-void append(Doubly_Linked_List* list_ref, int card, bool isDrawstack) {
+ReturnValue append(Doubly_Linked_List* list_ref, int card, bool isDrawstack) {
   Node* node = newNode(card);
+  if (node == NULL)
+  {
+    return OUT_OF_MEMORY;
+  }
   if (list_ref->head_ == NULL)
   {
     node->is_faced_up_ = true;
     list_ref->head_ = node;
     list_ref->tail_ = node;
-    return;
+    return EVERYTHING_OK;
   }
   list_ref->tail_->next_ = node;
   node->prev_ = list_ref->tail_;
@@ -891,6 +972,7 @@ void append(Doubly_Linked_List* list_ref, int card, bool isDrawstack) {
   {
     list_ref->tail_->prev_->is_faced_up_ = false;
   }
+  return EVERYTHING_OK;
 }
 
 //-----------------------------------------------------------------------------
@@ -900,19 +982,25 @@ void append(Doubly_Linked_List* list_ref, int card, bool isDrawstack) {
 /// @param list_ref struct of the doubly linked list
 /// @param card defines the card to add
 ///
+/// @return value to evaluate the occurrence of an error
 //
-void push(Doubly_Linked_List* list_ref, int card)
+ReturnValue push(Doubly_Linked_List* list_ref, int card)
 {
   Node* node = newNode(card);
+  if (node == NULL)
+  {
+    return OUT_OF_MEMORY;
+  }
   if (list_ref->head_ == NULL)
   {
     list_ref->head_ = node;
     list_ref->tail_ = node;
-    return;
+    return EVERYTHING_OK;
   }
   list_ref->head_->prev_ = node;
   node->next_ = list_ref->head_;
   list_ref->head_ = node;
+  return EVERYTHING_OK;
 }
 
 //-----------------------------------------------------------------------------
@@ -921,11 +1009,15 @@ void push(Doubly_Linked_List* list_ref, int card)
 ///
 /// @param card defines the card to add
 ///
-/// @return struct node that was created
+/// @return struct node that was created, NULL if out of memory
 //
 Node* newNode(int card)
 {
   Node* node = (Node*)malloc(sizeof(Node));
+  if (node == NULL)
+  {
+    return NULL;
+  }
   node->card_value_ = card;
   node->is_faced_up_ = false;
   node->next_ = NULL;
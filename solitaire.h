@@ -0,0 +1,121 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#ifndef SOLITAIRE_H
+#define SOLITAIRE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#define NUMBER_OF_STACKS 7
+#define NUMBER_OF_GAMESTACKS 4
+#define NUMBER_OF_CARDFACES 2
+#define NUMBER_OF_CARDS 26
+#define BOARD_SIZE 16
+#define MAX_COMMAND_ARG 5
+#define QUIT_GAME_ERRORS -4
+#define DRAWSTACK 0
+#define NO_CARD -1
+#define MAX_NEXT_COUNT 1000000
+
+// Memory allocation
+#define SIZE 20
+#define TWO 2
+
+#define WHITESPACE 32
+#define BLACK_KING 24
+
+#define DEPOSIT_STACK_1 5
+#define DEPOSIT_STACK_2 6
+
+// Sum of both deposit tails once the black and the red king are deposited
+#define WINNING_DEPOSIT_SUM 49
+
+// Commands
+#define COMMAND_TYPE 0
+#define COMMAND_FIRST_ARG 1
+#define MOVE_CARD_COLOR 1
+#define MOVE_CARD_RANK 2
+#define MOVE_TO 3
+#define MOVE_TARGET_STACK 4
+
+// Struct defines values for cards and are used for creating a
+// doubly linked list
+typedef struct Node
+{
+  int card_value_;
+  bool is_faced_up_;
+  struct Node* next_;
+  struct Node* prev_;
+}Node;
+
+typedef struct _Doubly_Linked_List_
+{
+  Node* head_;
+  Node* tail_;
+}Doubly_Linked_List;
+
+// Return values of the program
+typedef enum _ReturnValue_
+{
+  SHOW_HINT = 3,
+  MOVED = 2,
+  EXIT_GAME = 1,
+  EVERYTHING_OK = 0,
+  INVALID_MOVE_COMMAND = -1,
+  INVALID_COMMAND = -2,
+  INVALID_CARD = -3,
+  INVALID_ARG_COUNT = -4,
+  INVALID_FILE = -5,
+  OUT_OF_MEMORY = -6,
+  UNIDENTIFIED_ERROR = -7,
+  INVALID_CHECKPOINT = -8,
+  INVALID_SHARED_MEMORY = -9,
+  INVALID_TABLEBASE = -10,
+  SHARED_MEMORY_IN_USE = -11,
+  DUPLICATE_CARD = -12
+} ReturnValue;
+
+// Called by playGame with the board and the result of every command
+typedef void (*CommandObserver)(Doubly_Linked_List stacks[],
+  ReturnValue result, void* context);
+
+// Forward declarations
+ReturnValue printErrorMessage(ReturnValue return_value);
+ReturnValue append(Doubly_Linked_List* list_ref, int card, bool isDrawstack);
+ReturnValue push(Doubly_Linked_List* list_ref, int card);
+int pop(Doubly_Linked_List* list_ref);
+void rotateDrawstack(Doubly_Linked_List* drawstack, int count);
+void arrangeCards(Doubly_Linked_List stacks[]);
+Node* newNode(int card_value);
+ReturnValue readCard(FILE* file, int* card);
+ReturnValue readDeal(FILE* file, Doubly_Linked_List* draw_stack);
+ReturnValue readConfig(FILE* file, Doubly_Linked_List* draw_stack);
+void printGame(Doubly_Linked_List stacks[]);
+void printCard(Node* card);
+ReturnValue readInput(FILE* input, char** user_input, int* size);
+ReturnValue playGame(Doubly_Linked_List stacks[], FILE* input,
+  CommandObserver observer, void* context);
+ReturnValue handleCommand(Doubly_Linked_List stacks[], char* user_input);
+ReturnValue printHelp(char* command[]);
+ReturnValue moveCommand(Doubly_Linked_List stacks[], char* command[]);
+ReturnValue nextCommand(Doubly_Linked_List stacks[], char* command[]);
+ReturnValue moveCard(Doubly_Linked_List stacks[], int target_card,
+  int target_stack);
+bool isGameWon(Doubly_Linked_List stacks[]);
+bool checkMove(Doubly_Linked_List stacks[], int target_card, int target_stack,
+   int* target_card_index, int* target_card_stack);
+bool searchCard(Doubly_Linked_List stacks[], int target_card,
+   int* target_card_index, int* target_card_stack);
+bool twoCardsInOrder(int bottom_card, int top_card, int target_stack);
+bool checkOrder(Doubly_Linked_List stack, int target_card_index,
+   int target_stack);
+void deleteStacks(Doubly_Linked_List stacks[]);
+ReturnValue strToCard(char* color, char* rank, int* card);
+ReturnValue splitString(char* string, char* arguments[]);
+ReturnValue move(Doubly_Linked_List stacks[], int target_stack,
+  int target_card_index, int target_card_stack);
+
+#endif // SOLITAIRE_H
@@ -0,0 +1,909 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "solver.h"
+#include "tablebase.h"
+#include "trace.h"
+#include "util.h"
+
+#define FNV_OFFSET_BASIS 1469598103934665603ULL
+#define FNV_PRIME 1099511628211ULL
+#define EMPTY_KEY 0ULL
+
+//-----------------------------------------------------------------------------
+///
+/// Copies the doubly linked lists of the game into a compact board
+///
+/// @param board board to fill
+/// @param stacks array struct of the doubly linked list
+///
+//
+void boardFromStacks(Board* board, Doubly_Linked_List stacks[])
+{
+  memset(board, 0, sizeof(Board));
+  for (int stack = 0; stack < NUMBER_OF_STACKS; stack++)
+  {
+    for (Node* card = stacks[stack].head_; card != NULL &&
+      board->size_[stack] < NUMBER_OF_CARDS; card = card->next_)
+    {
+      board->cards_[stack][board->size_[stack]++] = card->card_value_;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Builds the board of a deal the same way readConfig and arrangeCards do
+///
+/// @param board board to fill
+/// @param cards the cards of the deal in the order of the config file
+///
+//
+void boardFromDeal(Board* board, const int cards[])
+{
+  memset(board, 0, sizeof(Board));
+  for (int card = 0; card < NUMBER_OF_CARDS; card++)
+  {
+    board->cards_[DRAWSTACK][card] = cards[card];
+  }
+  board->size_[DRAWSTACK] = NUMBER_OF_CARDS;
+
+  for (int row = 1 ; row < NUMBER_OF_GAMESTACKS + 1 ; row++)
+  {
+    for (int col = row ; col < NUMBER_OF_GAMESTACKS + 1 ; col++)
+    {
+      board->cards_[col][board->size_[col]++] =
+        board->cards_[DRAWSTACK][--board->size_[DRAWSTACK]];
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Shuffles all 26 cards. The same seed always gives the same deal.
+///
+/// @param seed number of the deal
+/// @param cards array to store the cards in the order of a config file
+///
+//
+void shuffleDeal(unsigned long long seed, int cards[])
+{
+  unsigned long long state = seed;
+  for (int card = 0; card < NUMBER_OF_CARDS; card++)
+  {
+    cards[card] = card;
+  }
+  for (int card = NUMBER_OF_CARDS - 1; card > 0; card--)
+  {
+    int other = randomNumber(&state) % (card + 1);
+    int swap = cards[card];
+    cards[card] = cards[other];
+    cards[other] = swap;
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Seed of the deal with the given number in a seeded series of deals
+///
+/// @param seed seed of the series
+/// @param game number of the deal
+///
+/// @return seed for shuffleDeal
+//
+unsigned long long dealSeed(unsigned long long seed, long long game)
+{
+  unsigned long long state = seed;
+  return randomNumber(&state) + (unsigned long long)game;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Steps a splitmix64 generator
+///
+/// @param state state of the generator
+///
+/// @return next random number
+//
+unsigned long long randomNumber(unsigned long long* state)
+{
+  unsigned long long value = (*state += 0x9E3779B97F4A7C15ULL);
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Checks if both kings lie on top of the deposit stacks
+///
+/// @param board board to check
+///
+/// @return boolean data type true or false
+//
+bool isWon(const Board* board)
+{
+  int size_1 = board->size_[DEPOSIT_STACK_1];
+  int size_2 = board->size_[DEPOSIT_STACK_2];
+  return size_1 != 0 && size_2 != 0 &&
+    board->cards_[DEPOSIT_STACK_1][size_1 - 1] +
+    board->cards_[DEPOSIT_STACK_2][size_2 - 1] == WINNING_DEPOSIT_SUM;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Locates a face up card the same way searchCard does on the linked lists:
+/// only the tail of the draw stack is faced up, as are all other cards
+///
+/// @param board board to search
+/// @param card card to look for
+/// @param stack pointer to store the stack of the card
+/// @param index pointer to store the position of the card in its stack
+///
+/// @return boolean data type true or false
+//
+static bool locateCard(const Board* board, int card, int* stack, int* index)
+{
+  for (int col = 0; col < NUMBER_OF_STACKS; col++)
+  {
+    int size = board->size_[col];
+    int first = col == DRAWSTACK ? size - 1 : 0;
+    for (int row = first < 0 ? 0 : first; row < size && row < BOARD_SIZE;
+      row++)
+    {
+      if (board->cards_[col][row] == card)
+      {
+        *stack = col;
+        *index = row;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Checks if a card may be put onto target_stack, mirroring checkMove
+///
+/// @param board board to check
+/// @param card card to move
+/// @param target_stack stack to move to
+///
+/// @return boolean data type true or false
+//
+static bool fitsOnto(const Board* board, int card, int target_stack)
+{
+  int target_size = board->size_[target_stack];
+  if (target_size == 0)
+  {
+    if (target_stack <= NUMBER_OF_GAMESTACKS)
+    {
+      return card >= BLACK_KING;
+    }
+    return card < NUMBER_OF_CARDFACES;
+  }
+  return twoCardsInOrder(board->cards_[target_stack][target_size - 1], card,
+    target_stack);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Finds the lowest card of a stack that has only cards in order on top of
+/// it, as checkOrder requires for a move onto target_stack
+///
+/// @param board board to check
+/// @param stack stack to check
+/// @param target_stack a game stack or a deposit stack
+///
+/// @return index of the lowest movable card
+//
+static int runStart(const Board* board, int stack, int target_stack)
+{
+  const signed char* cards = board->cards_[stack];
+  int index = board->size_[stack] - 1;
+  while (index > 0 && twoCardsInOrder(cards[index - 1], cards[index],
+    target_stack))
+  {
+    index--;
+  }
+  return index;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Collects every move command that would change the board. Deposit moves
+/// come first and NEXT last, which lets the solver find wins early.
+///
+/// @param board board to generate moves for
+/// @param moves array with room for MAX_MOVES moves
+///
+/// @return number of moves
+//
+int generateMoves(const Board* board, Move moves[])
+{
+  static const int targets[NUMBER_OF_STACKS - 1] = { DEPOSIT_STACK_1,
+    DEPOSIT_STACK_2, 1, 2, 3, 4 };
+  int count = 0;
+
+  // Position the game would pick for every card, as searchCard does
+  signed char first_stack[NUMBER_OF_CARDS];
+  signed char first_index[NUMBER_OF_CARDS];
+  memset(first_stack, -1, sizeof(first_stack));
+  for (int col = 0; col < NUMBER_OF_STACKS; col++)
+  {
+    int size = board->size_[col];
+    int first = col == DRAWSTACK ? size - 1 : 0;
+    for (int row = first < 0 ? 0 : first; row < size && row < BOARD_SIZE;
+      row++)
+    {
+      int card = board->cards_[col][row];
+      if (first_stack[card] < 0)
+      {
+        first_stack[card] = col;
+        first_index[card] = row;
+      }
+    }
+  }
+  // Lowest movable card of every game stack onto game and deposit stacks
+  signed char run_start[TWO][NUMBER_OF_GAMESTACKS + 1];
+  for (int stack = 1; stack <= NUMBER_OF_GAMESTACKS; stack++)
+  {
+    run_start[0][stack] = runStart(board, stack, 1);
+    run_start[1][stack] = runStart(board, stack, DEPOSIT_STACK_1);
+  }
+
+  for (int target = 0; target < NUMBER_OF_STACKS - 1; target++)
+  {
+    int target_stack = targets[target];
+    bool to_deposit = target_stack > NUMBER_OF_GAMESTACKS;
+    for (int stack = 0; stack <= NUMBER_OF_GAMESTACKS; stack++)
+    {
+      int size = board->size_[stack];
+      int first = stack == DRAWSTACK ? size - 1 : run_start[to_deposit][stack];
+      if (stack == target_stack || size == 0)
+      {
+        continue;
+      }
+      for (int index = first; index < size && index < BOARD_SIZE; index++)
+      {
+        int card = board->cards_[stack][index];
+        // Duplicate cards are resolved to the one the game would pick
+        if (first_stack[card] == stack && first_index[card] == index &&
+          fitsOnto(board, card, target_stack))
+        {
+          moves[count].card_ = card;
+          moves[count].target_stack_ = target_stack;
+          count++;
+        }
+      }
+    }
+  }
+
+  if (board->size_[DRAWSTACK] > 1)
+  {
+    moves[count].card_ = 1;
+    moves[count].target_stack_ = DRAWSTACK;
+    count++;
+  }
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Collects the moves the solver searches. Single NEXT moves are replaced by
+/// one rotation per draw stack card that could be played once it is on top,
+/// nearest first, so bringing a card to the top is one edge of the search.
+/// Rotating only pays off right before the top card is played, and two
+/// rotations in a row are one rotation, so a board reached by a rotation
+/// gets none.
+///
+/// @param board board to generate moves for
+/// @param moves array with room for MAX_MOVES moves
+/// @param rotations false if the board was reached by a rotation
+///
+/// @return number of moves
+//
+static int generateSearchMoves(const Board* board, Move moves[],
+  bool rotations)
+{
+  int count = generateMoves(board, moves);
+  int size = board->size_[DRAWSTACK];
+  if (size < TWO)
+  {
+    return count;
+  }
+  count--; // the single NEXT is always generated last
+
+  for (int index = size - TWO; rotations && index >= 0; index--)
+  {
+    int card = board->cards_[DRAWSTACK][index];
+    for (int target_stack = 1; target_stack < NUMBER_OF_STACKS; target_stack++)
+    {
+      if (fitsOnto(board, card, target_stack))
+      {
+        moves[count].card_ = size - 1 - index;
+        moves[count].target_stack_ = DRAWSTACK;
+        count++;
+        break;
+      }
+    }
+  }
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Executes a move that was generated for this board
+///
+/// @param board board to change
+/// @param move move to execute
+///
+//
+void applyMove(Board* board, Move move)
+{
+  if (move.target_stack_ == DRAWSTACK)
+  {
+    // The top count cards go to the bottom in the same order
+    int size = board->size_[DRAWSTACK];
+    int count = size == 0 ? 0 : move.card_ % size;
+    signed char top[NUMBER_OF_CARDS];
+    signed char* cards = board->cards_[DRAWSTACK];
+    memcpy(top, &cards[size - count], count);
+    memmove(&cards[count], &cards[0], size - count);
+    memcpy(&cards[0], top, count);
+    return;
+  }
+
+  int stack;
+  int index;
+  if (!locateCard(board, move.card_, &stack, &index))
+  {
+    return;
+  }
+  int count = board->size_[stack] - index;
+  int target_size = board->size_[move.target_stack_];
+  memcpy(&board->cards_[move.target_stack_][target_size],
+    &board->cards_[stack][index], count);
+  board->size_[move.target_stack_] += count;
+  board->size_[stack] = index;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Hashes the board with FNV-1a
+///
+/// @param board board to hash
+///
+/// @return 64 bit hash which is never zero
+//
+unsigned long long hashBoard(const Board* board)
+{
+  unsigned long long hash = FNV_OFFSET_BASIS;
+  for (int stack = 0; stack < NUMBER_OF_STACKS; stack++)
+  {
+    hash = (hash ^ board->size_[stack]) * FNV_PRIME;
+    for (int index = 0; index < board->size_[stack]; index++)
+    {
+      hash = (hash ^ (unsigned char)board->cards_[stack][index]) * FNV_PRIME;
+    }
+  }
+  return hash == EMPTY_KEY ? 1 : hash;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Mixes the bits of a 64 bit value, the finalizer of splitmix64
+///
+/// @param value value to mix
+///
+/// @return mixed value
+//
+static unsigned long long mixKey(unsigned long long value)
+{
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Sorts a few keys in ascending order
+///
+/// @param keys keys to sort
+/// @param count number of keys
+///
+//
+static void sortKeys(unsigned long long keys[], int count)
+{
+  for (int index = 1; index < count; index++)
+  {
+    unsigned long long key = keys[index];
+    int position = index;
+    for (; position > 0 && keys[position - 1] > key; position--)
+    {
+      keys[position] = keys[position - 1];
+    }
+    keys[position] = key;
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Hashes the board so that all boards equal up to a symmetry of the rules
+/// get the same key. The four game stacks are interchangeable and so are
+/// the two deposit stacks, so their hashes are combined in sorted order.
+/// Swapping the colors of all cards (card ^ 1) keeps every rule, so the
+/// smaller key of the board and of its color swapped twin is used. Building
+/// with -DNO_SYMMETRY falls back to hashBoard.
+///
+/// @param board board to hash
+///
+/// @return 64 bit hash which is never zero
+//
+unsigned long long canonicalHash(const Board* board)
+{
+#ifdef NO_SYMMETRY
+  return hashBoard(board);
+#else
+  unsigned long long stacks[NUMBER_OF_CARDFACES][NUMBER_OF_STACKS];
+  unsigned long long keys[NUMBER_OF_CARDFACES];
+
+  for (int stack = 0; stack < NUMBER_OF_STACKS; stack++)
+  {
+    unsigned long long hash = (FNV_OFFSET_BASIS ^ board->size_[stack]) *
+      FNV_PRIME;
+    unsigned long long swapped = hash;
+    for (int index = 0; index < board->size_[stack]; index++)
+    {
+      unsigned char card = board->cards_[stack][index];
+      hash = (hash ^ card) * FNV_PRIME;
+      swapped = (swapped ^ (card ^ 1)) * FNV_PRIME;
+    }
+    stacks[0][stack] = hash;
+    stacks[1][stack] = swapped;
+  }
+  for (int face = 0; face < NUMBER_OF_CARDFACES; face++)
+  {
+    sortKeys(&stacks[face][1], NUMBER_OF_GAMESTACKS);
+    sortKeys(&stacks[face][DEPOSIT_STACK_1], TWO);
+    keys[face] = FNV_OFFSET_BASIS;
+    for (int stack = 0; stack < NUMBER_OF_STACKS; stack++)
+    {
+      keys[face] = mixKey(keys[face] ^ stacks[face][stack]);
+    }
+  }
+  unsigned long long key = keys[0] < keys[1] ? keys[0] : keys[1];
+  return key == EMPTY_KEY ? 1 : key;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Prints a move the way a user would type it
+///
+/// @param move move to print
+///
+//
+void printMove(Move move)
+{
+
+  if (move.target_stack_ == DRAWSTACK)
+  {
+    if (move.card_ == 1)
+    {
+      printf("NEXT\n");
+      return;
+    }
+    printf("NEXT %d\n", move.card_);
+    return;
+  }
+  printf("MOVE %s %s TO %d\n", move.card_ % TWO == 0 ? "BLACK" : "RED",
+    rankName(move.card_), move.target_stack_);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Allocates the table of visited boards
+///
+/// @param set set to initialise
+/// @param capacity number of slots, must be a power of two
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue visitedInit(VisitedSet* set, size_t capacity)
+{
+  set->keys_ = (unsigned long long*) calloc(capacity, sizeof(*set->keys_));
+  set->capacity_ = capacity;
+  set->count_ = 0;
+  set->flushes_ = 0;
+  return set->keys_ == NULL ? OUT_OF_MEMORY : EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Inserts a board hash. A full table is flushed instead of grown so the
+/// memory of a search stays bounded.
+///
+/// @param set set to insert into
+/// @param key hash of the board
+///
+/// @return true if the key was not in the set yet
+//
+bool visitedInsert(VisitedSet* set, unsigned long long key)
+{
+  if (set->count_ * 4 >= set->capacity_ * 3)
+  {
+    unsigned long long start = TRACE_BEGIN();
+    visitedClear(set);
+    set->flushes_++;
+    TRACE_END("table flush", start, "entries", (long long)set->capacity_);
+  }
+  size_t mask = set->capacity_ - 1;
+  for (size_t slot = key & mask; ; slot = (slot + 1) & mask)
+  {
+    if (set->keys_[slot] == key)
+    {
+      return false;
+    }
+    if (set->keys_[slot] == EMPTY_KEY)
+    {
+      set->keys_[slot] = key;
+      set->count_++;
+      return true;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Checks if a board hash is in the set
+///
+/// @param set set to search
+/// @param key hash of the board
+///
+/// @return boolean data type true or false
+//
+bool visitedContains(const VisitedSet* set, unsigned long long key)
+{
+  size_t mask = set->capacity_ - 1;
+  for (size_t slot = key & mask; set->keys_[slot] != EMPTY_KEY;
+    slot = (slot + 1) & mask)
+  {
+    if (set->keys_[slot] == key)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Removes all keys from the set
+///
+/// @param set set to clear
+///
+//
+void visitedClear(VisitedSet* set)
+{
+  memset(set->keys_, 0, set->capacity_ * sizeof(*set->keys_));
+  set->count_ = 0;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Frees the table of visited boards
+///
+/// @param set set to free
+///
+//
+void visitedFree(VisitedSet* set)
+{
+  free(set->keys_);
+  set->keys_ = NULL;
+  set->capacity_ = 0;
+  set->count_ = 0;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Initialises a depth first solver
+///
+/// @param solver solver to initialise
+/// @param node_budget maximum number of boards to generate per deal
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue solverInit(Solver* solver, unsigned long long node_budget)
+{
+  solver->frames_ = (SearchFrame*) malloc(INITIAL_SEARCH_DEPTH *
+    sizeof(SearchFrame));
+  solver->depth_ = 0;
+  solver->capacity_ = INITIAL_SEARCH_DEPTH;
+  solver->nodes_ = 0;
+  solver->node_budget_ = node_budget;
+  solver->tablebase_ = NULL;
+  if (solver->frames_ == NULL)
+  {
+    return OUT_OF_MEMORY;
+  }
+  if (visitedInit(&solver->visited_, VISITED_TABLE_SIZE) != EVERYTHING_OK)
+  {
+    free(solver->frames_);
+    solver->frames_ = NULL;
+    return OUT_OF_MEMORY;
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Frees a solver
+///
+/// @param solver solver to free
+///
+//
+void solverFree(Solver* solver)
+{
+  free(solver->frames_);
+  solver->frames_ = NULL;
+  visitedFree(&solver->visited_);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Pushes a board on the search stack
+///
+/// @param solver solver to push to
+/// @param board board of the new frame
+/// @param rotations false if the board was reached by a rotation
+///
+/// @return pointer to the new frame, NULL if out of memory
+//
+static SearchFrame* pushFrame(Solver* solver, const Board* board,
+  bool rotations)
+{
+  if (solver->depth_ == solver->capacity_)
+  {
+    SearchFrame* frames = (SearchFrame*) realloc(solver->frames_,
+      solver->capacity_ * TWO * sizeof(SearchFrame));
+    if (frames == NULL)
+    {
+      return NULL;
+    }
+    solver->frames_ = frames;
+    solver->capacity_ *= TWO;
+  }
+  SearchFrame* frame = &solver->frames_[solver->depth_++];
+  frame->board_ = *board;
+  frame->move_count_ = generateSearchMoves(board, frame->moves_, rotations);
+  frame->next_move_ = 0;
+  return frame;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Starts a new search
+///
+/// @param solver solver to use
+/// @param board board to solve
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue solverStart(Solver* solver, const Board* board)
+{
+  solver->depth_ = 0;
+  solver->nodes_ = 0;
+  visitedClear(&solver->visited_);
+  visitedInsert(&solver->visited_, canonicalHash(board));
+  return pushFrame(solver, board, true) == NULL ? OUT_OF_MEMORY :
+    EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Continues a search from a path saved by solverProgress. Boards visited
+/// before the save are not known anymore and may be searched again.
+///
+/// @param solver solver to use
+/// @param board board the saved search was started on
+/// @param path index of the next move of every frame
+/// @param depth number of frames in path
+/// @param nodes number of boards generated before the save
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue solverRestore(Solver* solver, const Board* board,
+  const int path[], int depth, unsigned long long nodes)
+{
+  if (depth < 1 || solverStart(solver, board) != EVERYTHING_OK)
+  {
+    return depth < 1 ? INVALID_CHECKPOINT : OUT_OF_MEMORY;
+  }
+  solver->nodes_ = nodes;
+
+  for (int level = 0; level < depth; level++)
+  {
+    SearchFrame* frame = &solver->frames_[level];
+    bool has_child = level + 1 < depth;
+    if (path[level] < (has_child ? 1 : 0) || path[level] > frame->move_count_)
+    {
+      return INVALID_CHECKPOINT;
+    }
+    frame->next_move_ = path[level];
+    if (has_child)
+    {
+      Move move = frame->moves_[path[level] - 1];
+      Board child = frame->board_;
+      applyMove(&child, move);
+      visitedInsert(&solver->visited_, canonicalHash(&child));
+      if (pushFrame(solver, &child, move.target_stack_ != DRAWSTACK) == NULL)
+      {
+        return OUT_OF_MEMORY;
+      }
+    }
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Finishes the search from a top frame that is covered by the tablebase by
+/// pushing the moves of the table until the board is won. Every frame gets
+/// all rotations, so there is always a move that gets closer to the win.
+///
+/// @param solver solver with a covered top frame
+///
+/// @return SOLVE_WON, SOLVE_LOST if the table has no win for the board
+//
+static SolveResult playEndgame(Solver* solver)
+{
+  SearchFrame* frame = &solver->frames_[solver->depth_ - 1];
+  if (tablebaseLookup(solver->tablebase_, &frame->board_) == NOT_WINNABLE)
+  {
+    solver->depth_ = 0;
+    return SOLVE_LOST;
+  }
+  frame->move_count_ = generateSearchMoves(&frame->board_, frame->moves_,
+    true);
+  while (!isWon(&frame->board_))
+  {
+    int index = tablebaseMove(solver->tablebase_, &frame->board_,
+      frame->moves_, frame->move_count_);
+    if (index < 0)
+    {
+      return SOLVE_UNKNOWN;
+    }
+    frame->next_move_ = index + 1;
+    Board child = frame->board_;
+    applyMove(&child, frame->moves_[index]);
+    solver->nodes_++;
+    if ((frame = pushFrame(solver, &child, true)) == NULL)
+    {
+      return SOLVE_UNKNOWN;
+    }
+  }
+  return SOLVE_WON;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Runs the depth first search for a limited number of boards, so callers
+/// can save the progress in between
+///
+/// @param solver solver to run
+/// @param node_limit number of boards to generate before returning
+///
+/// @return SOLVE_RUNNING if node_limit was reached, otherwise the result
+//
+SolveResult solverRun(Solver* solver, unsigned long long node_limit)
+{
+  unsigned long long stop = solver->nodes_ + node_limit;
+
+  if (solver->depth_ == 1 && solver->frames_[0].next_move_ == 0)
+  {
+    const Board* board = &solver->frames_[0].board_;
+    if (isWon(board))
+    {
+      return SOLVE_WON;
+    }
+    if (tablebaseCovers(solver->tablebase_, board))
+    {
+      return playEndgame(solver);
+    }
+  }
+
+  while (solver->depth_ > 0)
+  {
+    if (solver->nodes_ >= solver->node_budget_)
+    {
+      return SOLVE_UNKNOWN;
+    }
+    if (solver->nodes_ >= stop)
+    {
+      return SOLVE_RUNNING;
+    }
+
+    SearchFrame* frame = &solver->frames_[solver->depth_ - 1];
+    if (frame->next_move_ == frame->move_count_)
+    {
+      solver->depth_--;
+      continue;
+    }
+
+    Move move = frame->moves_[frame->next_move_++];
+    Board child = frame->board_;
+    applyMove(&child, move);
+    solver->nodes_++;
+    if (!visitedInsert(&solver->visited_, canonicalHash(&child)))
+    {
+      continue;
+    }
+    bool endgame = tablebaseCovers(solver->tablebase_, &child);
+    if (endgame && tablebaseLookup(solver->tablebase_, &child) == NOT_WINNABLE)
+    {
+      continue;
+    }
+    if (pushFrame(solver, &child, move.target_stack_ != DRAWSTACK) == NULL)
+    {
+      return SOLVE_UNKNOWN;
+    }
+    if (isWon(&child))
+    {
+      return SOLVE_WON;
+    }
+    if (endgame)
+    {
+      return playEndgame(solver);
+    }
+  }
+  return SOLVE_LOST;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Reads the winning line after solverRun returned SOLVE_WON
+///
+/// @param solver solver that found a win
+/// @param moves array to store the moves
+/// @param max_moves size of the moves array
+///
+/// @return number of moves of the whole line
+//
+int solverSolution(const Solver* solver, Move moves[], int max_moves)
+{
+  int length = solver->depth_ - 1;
+  for (int level = 0; level < length && level < max_moves; level++)
+  {
+    const SearchFrame* frame = &solver->frames_[level];
+    moves[level] = frame->moves_[frame->next_move_ - 1];
+  }
+  return length;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Saves the position of the search as the index of the next move of every
+/// frame. Together with the start board this restores the whole stack.
+///
+/// @param solver solver to save
+/// @param path array to store the indices
+/// @param max_depth size of the path array
+///
+/// @return depth of the search stack
+//
+int solverProgress(const Solver* solver, int path[], int max_depth)
+{
+  for (int level = 0; level < solver->depth_ && level < max_depth; level++)
+  {
+    path[level] = solver->frames_[level].next_move_;
+  }
+  return solver->depth_;
+}
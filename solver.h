@@ -0,0 +1,102 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stddef.h>
+
+#include "solitaire.h"
+
+// Sources (draw stack top and every game stack card) times targets plus one
+// rotation for every card of the draw stack
+#define MAX_MOVES 194
+#define VISITED_TABLE_SIZE (1 << 20)
+#define INITIAL_SEARCH_DEPTH 64
+
+// Compact copy of the game used by the solver. Every stack is stored from
+// bottom to top, so index size_ - 1 is the tail of the doubly linked list.
+typedef struct _Board_
+{
+  signed char cards_[NUMBER_OF_STACKS][NUMBER_OF_CARDS];
+  unsigned char size_[NUMBER_OF_STACKS];
+} Board;
+
+// A move command. A target stack of DRAWSTACK stands for NEXT, card_ then
+// holds how often the draw stack is rotated.
+typedef struct _Move_
+{
+  signed char card_;
+  signed char target_stack_;
+} Move;
+
+typedef enum _SolveResult_
+{
+  SOLVE_RUNNING = 2,
+  SOLVE_WON = 1,
+  SOLVE_LOST = 0,
+  SOLVE_UNKNOWN = -1
+} SolveResult;
+
+// Open addressing set of board hashes, flushed once it is three quarters full
+typedef struct _VisitedSet_
+{
+  unsigned long long* keys_;
+  size_t capacity_;
+  size_t count_;
+  unsigned long long flushes_;
+} VisitedSet;
+
+typedef struct _SearchFrame_
+{
+  Board board_;
+  Move moves_[MAX_MOVES];
+  int move_count_;
+  int next_move_;
+} SearchFrame;
+
+struct _Tablebase_;
+
+// With a tablebase, covered boards are not searched: lost ones are pruned
+// and won ones are played out with the moves of the table.
+typedef struct _Solver_
+{
+  SearchFrame* frames_;
+  int depth_;
+  int capacity_;
+  VisitedSet visited_;
+  unsigned long long nodes_;
+  unsigned long long node_budget_;
+  const struct _Tablebase_* tablebase_;
+} Solver;
+
+void boardFromStacks(Board* board, Doubly_Linked_List stacks[]);
+void boardFromDeal(Board* board, const int cards[]);
+void shuffleDeal(unsigned long long seed, int cards[]);
+unsigned long long dealSeed(unsigned long long seed, long long game);
+unsigned long long randomNumber(unsigned long long* state);
+bool isWon(const Board* board);
+int generateMoves(const Board* board, Move moves[]);
+void applyMove(Board* board, Move move);
+unsigned long long hashBoard(const Board* board);
+unsigned long long canonicalHash(const Board* board);
+void printMove(Move move);
+
+ReturnValue visitedInit(VisitedSet* set, size_t capacity);
+bool visitedInsert(VisitedSet* set, unsigned long long key);
+bool visitedContains(const VisitedSet* set, unsigned long long key);
+void visitedClear(VisitedSet* set);
+void visitedFree(VisitedSet* set);
+
+ReturnValue solverInit(Solver* solver, unsigned long long node_budget);
+void solverFree(Solver* solver);
+ReturnValue solverStart(Solver* solver, const Board* board);
+ReturnValue solverRestore(Solver* solver, const Board* board,
+  const int path[], int depth, unsigned long long nodes);
+SolveResult solverRun(Solver* solver, unsigned long long node_limit);
+int solverSolution(const Solver* solver, Move moves[], int max_moves);
+int solverProgress(const Solver* solver, int path[], int max_depth);
+
+#endif // SOLVER_H
@@ -0,0 +1,180 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+// Tails a game started with --publish NAME. Maps the shared board read only,
+// prints it whenever it changed and reports how fast the game publishes.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "publish.h"
+#include "util.h"
+
+#define DEFAULT_INTERVAL_MS 1000L
+#define EXIT_GAME_GONE 2
+#define WAIT_INTERVAL_MS 100L
+#define MILLISECONDS 1000L
+#define NANOSECONDS_PER_MILLISECOND 1000000L
+
+static void printBoard(const Board* board);
+static void sleepMilliseconds(long milliseconds);
+
+//-----------------------------------------------------------------------------
+///
+/// The reader tool
+///
+/// @param argc number of arguments
+/// @param argv NAME [--interval MS] [--quiet]
+///
+/// @return 0 once the game has ended, 2 if the game died without ending it,
+///         1 on errors
+//
+int main(int argc, char* argv[])
+{
+  long interval = DEFAULT_INTERVAL_MS;
+  bool quiet = false;
+
+  Option known[] = {
+    { "--interval", OPTION_LONG, &interval },
+    { "--quiet", OPTION_FLAG, &quiet } };
+  if (argc < TWO || parseOptions(argc, argv, TWO, known,
+    sizeof(known) / sizeof(known[0])) != EVERYTHING_OK || interval < 1)
+  {
+    fprintf(stderr, "Usage: ./spectate NAME [--interval MS] [--quiet]\n");
+    return 1;
+  }
+
+  // The game may not have been started yet
+  const SharedBoard* shared = NULL;
+  bool waiting = false;
+  while (subscriberOpen(argv[1], &shared) != EVERYTHING_OK)
+  {
+    if (!waiting)
+    {
+      printf("waiting for game %s\n", argv[1]);
+      fflush(stdout);
+      waiting = true;
+    }
+    sleepMilliseconds(WAIT_INTERVAL_MS);
+  }
+
+  BoardSnapshot snapshot;
+  unsigned long long retries = 0;
+  unsigned int sequence = 0;
+  memset(&snapshot, 0, sizeof(BoardSnapshot));
+  bool gone = readSnapshot(shared, &snapshot, &sequence, &retries) !=
+    EVERYTHING_OK;
+  unsigned int last_sequence = sequence - 1;
+  unsigned long long last_commands = snapshot.commands_;
+  struct timespec window_start;
+  clock_gettime(CLOCK_MONOTONIC, &window_start);
+
+  while (!gone)
+  {
+    // Fails if the game was killed in the middle of a publish
+    if (readSnapshot(shared, &snapshot, &sequence, &retries) != EVERYTHING_OK)
+    {
+      gone = true;
+      break;
+    }
+    if (sequence != last_sequence)
+    {
+      double seconds = secondsSince(&window_start);
+      clock_gettime(CLOCK_MONOTONIC, &window_start);
+      if (!quiet)
+      {
+        printBoard(&snapshot.board_);
+      }
+      double rate = seconds > 0 ?
+        (snapshot.commands_ - last_commands) / seconds : 0.0;
+      printf("commands %llu, %.0f commands/s, %u snapshots published, "
+        "%llu torn reads retried%s\n", snapshot.commands_, rate,
+        sequence / TWO, retries, isWon(&snapshot.board_) ? ", won" : "");
+      fflush(stdout);
+      last_sequence = sequence;
+      last_commands = snapshot.commands_;
+    }
+    if (!snapshot.running_)
+    {
+      break;
+    }
+    if (!writerAlive(shared))
+    {
+      gone = true;
+      break;
+    }
+    sleepMilliseconds(interval);
+  }
+  if (gone)
+  {
+    printf("game exited without ending after %llu commands\n",
+      last_commands);
+    subscriberClose(shared);
+    return EXIT_GAME_GONE;
+  }
+  printf("game ended after %llu commands\n", snapshot.commands_);
+  subscriberClose(shared);
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Prints a board in the layout of printGame
+///
+/// @param board board to print
+///
+//
+static void printBoard(const Board* board)
+{
+  char color[] = { 'B', 'R' };
+
+  printf("0   | 1   | 2   | 3   | 4   | DEP | DEP\n");
+  printf("---------------------------------------\n");
+  for (int row = 0; row < BOARD_SIZE; row++)
+  {
+    for (int col = 0; col < NUMBER_OF_STACKS; col++)
+    {
+      int size = board->size_[col];
+      if (col != 0)
+      {
+        printf(" ");
+      }
+      if (row >= size)
+      {
+        printf("   ");
+      }
+      else if (col == DRAWSTACK && row != size - 1)
+      {
+        printf("X  ");
+      }
+      else
+      {
+        int card = board->cards_[col][row];
+        printf("%c%-2s", color[card % TWO], rankName(card));
+      }
+      if (col != NUMBER_OF_STACKS - 1)
+      {
+        printf(" |");
+      }
+    }
+    printf("\n");
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Sleeps for a number of milliseconds
+///
+//
+static void sleepMilliseconds(long milliseconds)
+{
+  struct timespec duration;
+  duration.tv_sec = milliseconds / MILLISECONDS;
+  duration.tv_nsec = (milliseconds % MILLISECONDS) *
+    NANOSECONDS_PER_MILLISECOND;
+  nanosleep(&duration, NULL);
+}
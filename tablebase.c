@@ -0,0 +1,1166 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tablebase.h"
+#include "trace.h"
+#include "util.h"
+
+#define ENTRY_KEY_MASK 0xFFFFFFFFFFFFFF00ULL
+#define ENTRY_DISTANCE_MASK 0xFFULL
+#define ENTRY_DISTANCE_BITS 8
+#define MAX_DISTANCE 254
+#define STACK_SIZE_BITS 4
+#define CARD_BITS 5
+#define PACKED_WORD_BITS 64
+#define FRONTIER_CHUNK 256
+#define INITIAL_FOUND_SIZE 1024
+#define MEGABYTE (1024 * 1024)
+#define EMPTY_ENTRY 0ULL
+#define MAX_PRINTED_MISMATCHES 5
+
+// Stacks 0 to 4 as four bit sizes followed by five bits per card. The
+// deposits are implied by the cards that are missing.
+typedef struct _PackedBoard_
+{
+  unsigned long long bits_[TWO];
+} PackedBoard;
+
+// Shared state of a generation. Every layer holds the positions with the
+// same distance to the win and is expanded by all workers at once.
+typedef struct _TablebaseBuild_
+{
+  int max_cards_;
+  int threads_;
+  atomic_ullong* entries_;
+  size_t capacity_;
+  atomic_size_t count_;
+  const PackedBoard* frontier_;
+  size_t frontier_count_;
+  atomic_size_t next_position_;
+  int distance_;
+  size_t memory_limit_;
+  atomic_size_t memory_used_;
+  atomic_int error_;
+} TablebaseBuild;
+
+typedef struct _TablebaseWorker_
+{
+  pthread_t thread_;
+  TablebaseBuild* build_;
+  PackedBoard* found_;
+  size_t found_count_;
+  size_t found_capacity_;
+} TablebaseWorker;
+
+static ReturnValue parseTablebaseOptions(int argc, char* argv[],
+  int* max_cards, const char** output_path, int* memory, int* threads,
+  const char** trace_path);
+static ReturnValue buildTablebase(TablebaseBuild* build, Tablebase* tablebase,
+  int* longest);
+static ReturnValue expandLayer(TablebaseBuild* build,
+  TablebaseWorker workers[]);
+static void* tablebaseWorker(void* argument);
+static void expandBoard(TablebaseWorker* worker, const Board* board);
+static void moveTop(Board* board, int from, int count, int to);
+static int compareEntries(const void* first, const void* second);
+static void recordBoard(TablebaseWorker* worker, const Board* board);
+static bool insertEntry(TablebaseBuild* build, unsigned long long key,
+  int distance);
+static bool reserveMemory(TablebaseBuild* build, size_t bytes);
+static void releaseMemory(TablebaseBuild* build, size_t bytes);
+static void writeBits(PackedBoard* packed, int* position,
+  unsigned long long value, int bits);
+static unsigned long long readBits(const PackedBoard* packed, int* position,
+  int bits);
+static void packBoard(const Board* board, PackedBoard* packed);
+static void unpackBoard(const PackedBoard* packed, Board* board);
+static void wonBoard(Board* board);
+static ReturnValue writeTablebase(const Tablebase* tablebase, int longest,
+  const char* path);
+static ReturnValue checkEntries(const Tablebase* tablebase, int longest);
+static void randomEndgame(Board* board, int max_cards,
+  unsigned long long* random);
+static int forwardDistance(const Board* start, Board queue[], int distances[],
+  VisitedSet* visited);
+
+//-----------------------------------------------------------------------------
+///
+/// Generates the endgame tablebase for every position with at most K cards
+/// outside the deposits and writes it to a file
+///
+/// @param argc number of arguments
+/// @param argv program arguments
+///
+/// @return exit code of the program
+//
+int runTablebase(int argc, char* argv[])
+{
+  int max_cards = 0;
+  int memory = DEFAULT_TABLEBASE_MEMORY;
+  long processors = sysconf(_SC_NPROCESSORS_ONLN);
+  int threads = processors > 0 ? (int)processors : 1;
+  const char* output_path = NULL;
+  const char* trace_path = NULL;
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  ReturnValue return_value = parseTablebaseOptions(argc, argv, &max_cards,
+    &output_path, &memory, &threads, &trace_path);
+  if (return_value != EVERYTHING_OK)
+  {
+    return printErrorMessage(return_value);
+  }
+  if (trace_path != NULL &&
+    (return_value = traceStart(trace_path)) != EVERYTHING_OK)
+  {
+    return printErrorMessage(return_value);
+  }
+  traceThreadName("main");
+
+  TablebaseBuild build;
+  memset(&build, 0, sizeof(TablebaseBuild));
+  build.max_cards_ = max_cards;
+  build.threads_ = threads;
+  build.memory_limit_ = (size_t)memory * MEGABYTE;
+  Tablebase tablebase;
+  int longest = 0;
+  return_value = buildTablebase(&build, &tablebase, &longest);
+  if (return_value == OUT_OF_MEMORY)
+  {
+    printf("[INFO] Endgames with %d cards do not fit into %d MB!\n",
+      max_cards, memory);
+  }
+  if (return_value == EVERYTHING_OK)
+  {
+    return_value = writeTablebase(&tablebase, longest, output_path);
+  }
+  if (return_value == EVERYTHING_OK)
+  {
+    printf("endgames with up to %d cards: %zu winnable positions, longest "
+      "ending %d moves\n", max_cards, tablebase.count_, longest);
+    printf("wrote %zu entries (%.1f MB) to %s in %.2f s\n",
+      tablebase.capacity_, (double)(tablebase.capacity_ *
+      sizeof(unsigned long long)) / MEGABYTE, output_path,
+      secondsSince(&start));
+  }
+  traceStop();
+  tablebaseFree(&tablebase);
+  return return_value == EVERYTHING_OK ? EVERYTHING_OK :
+    printErrorMessage(return_value);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Reads the command line of a tablebase generation
+///
+/// @param argc number of arguments
+/// @param argv program arguments
+/// @param max_cards pointer to store the number of cards outside the deposits
+/// @param output_path pointer to store the path of the table
+/// @param memory pointer to store the memory budget in MB
+/// @param threads pointer to store the number of threads
+/// @param trace_path pointer to store the path of the trace or NULL
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue parseTablebaseOptions(int argc, char* argv[],
+  int* max_cards, const char** output_path, int* memory, int* threads,
+  const char** trace_path)
+{
+  Option known[] = {
+    { "--endgame", OPTION_INT, max_cards },
+    { "--output", OPTION_STRING, output_path },
+    { "--memory", OPTION_INT, memory },
+    { "--threads", OPTION_INT, threads },
+    { "--trace", OPTION_STRING, trace_path } };
+  if (parseOptions(argc, argv, 1, known, sizeof(known) / sizeof(known[0])) !=
+    EVERYTHING_OK || *max_cards < 1 || MAX_TABLEBASE_CARDS < *max_cards ||
+    *output_path == NULL || *memory < 1 || *threads < 1)
+  {
+    return INVALID_ARG_COUNT;
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Runs the retrograde analysis. Starting from the won board every layer
+/// takes back one move from all positions of the previous layer, so every
+/// position is first reached with its shortest distance to the win. Half of
+/// the memory budget goes to the hash table, the other half to the layers.
+///
+/// @param build generation with max_cards_, threads_ and memory_limit_ set
+/// @param tablebase tablebase to fill, compacted to its entries
+/// @param longest pointer to store the largest distance to the win
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue buildTablebase(TablebaseBuild* build, Tablebase* tablebase,
+  int* longest)
+{
+  memset(tablebase, 0, sizeof(Tablebase));
+  build->capacity_ = 1;
+  while (build->capacity_ * TWO * sizeof(atomic_ullong) <=
+    build->memory_limit_ / TWO)
+  {
+    build->capacity_ *= TWO;
+  }
+  TablebaseWorker* workers = (TablebaseWorker*) calloc(build->threads_,
+    sizeof(TablebaseWorker));
+  build->entries_ = (atomic_ullong*) calloc(build->capacity_,
+    sizeof(atomic_ullong));
+  PackedBoard* frontier = (PackedBoard*) malloc(sizeof(PackedBoard));
+  if (workers == NULL || build->entries_ == NULL || frontier == NULL)
+  {
+    free(workers);
+    free(build->entries_);
+    free(frontier);
+    return OUT_OF_MEMORY;
+  }
+  atomic_store(&build->memory_used_, build->capacity_ *
+    sizeof(atomic_ullong));
+
+  Board board;
+  wonBoard(&board);
+  insertEntry(build, canonicalHash(&board), 0);
+  packBoard(&board, frontier);
+  build->frontier_ = frontier;
+  build->frontier_count_ = 1;
+
+  ReturnValue return_value = EVERYTHING_OK;
+  while (build->frontier_count_ > 0 && return_value == EVERYTHING_OK)
+  {
+    if (build->distance_ == MAX_DISTANCE)
+    {
+      return_value = UNIDENTIFIED_ERROR;
+      break;
+    }
+    unsigned long long start = TRACE_BEGIN();
+    return_value = expandLayer(build, workers);
+    TRACE_END("layer", start, "positions", build->frontier_count_);
+    if (return_value != EVERYTHING_OK)
+    {
+      break;
+    }
+
+    // The positions found by all workers become the next layer
+    size_t count = 0;
+    for (int index = 0; index < build->threads_; index++)
+    {
+      count += workers[index].found_count_;
+    }
+    free(frontier);
+    releaseMemory(build, build->frontier_count_ * sizeof(PackedBoard));
+    frontier = NULL;
+    if (count > 0 && (!reserveMemory(build, count * sizeof(PackedBoard)) ||
+      (frontier = (PackedBoard*) malloc(count * sizeof(PackedBoard))) == NULL))
+    {
+      return_value = OUT_OF_MEMORY;
+      break;
+    }
+    count = 0;
+    for (int index = 0; index < build->threads_; index++)
+    {
+      memcpy(&frontier[count], workers[index].found_,
+        workers[index].found_count_ * sizeof(PackedBoard));
+      count += workers[index].found_count_;
+    }
+    build->frontier_ = frontier;
+    build->frontier_count_ = count;
+    if (count > 0)
+    {
+      build->distance_++;
+    }
+  }
+  free(frontier);
+  for (int index = 0; index < build->threads_; index++)
+  {
+    free(workers[index].found_);
+  }
+  free(workers);
+
+  // Rehashes the entries in sorted order into the smallest table that is at
+  // most three quarters full, so the file does not depend on the threads
+  size_t count = atomic_load(&build->count_);
+  unsigned long long* sorted = NULL;
+  if (return_value == EVERYTHING_OK && (sorted = (unsigned long long*)
+    malloc(count * sizeof(unsigned long long))) == NULL)
+  {
+    return_value = OUT_OF_MEMORY;
+  }
+  if (return_value == EVERYTHING_OK)
+  {
+    size_t found = 0;
+    for (size_t index = 0; index < build->capacity_; index++)
+    {
+      unsigned long long entry = atomic_load_explicit(&build->entries_[index],
+        memory_order_relaxed);
+      if (entry != EMPTY_ENTRY)
+      {
+        sorted[found++] = entry;
+      }
+    }
+    free(build->entries_);
+    build->entries_ = NULL;
+    qsort(sorted, count, sizeof(unsigned long long), compareEntries);
+
+    tablebase->capacity_ = 1;
+    while (tablebase->capacity_ * 3 < count * 4 + 4)
+    {
+      tablebase->capacity_ *= TWO;
+    }
+    tablebase->entries_ = (unsigned long long*) calloc(tablebase->capacity_,
+      sizeof(unsigned long long));
+    return_value = tablebase->entries_ == NULL ? OUT_OF_MEMORY :
+      EVERYTHING_OK;
+  }
+  if (return_value == EVERYTHING_OK)
+  {
+    size_t mask = tablebase->capacity_ - 1;
+    for (size_t index = 0; index < count; index++)
+    {
+      size_t slot = (sorted[index] >> ENTRY_DISTANCE_BITS) & mask;
+      while (tablebase->entries_[slot] != EMPTY_ENTRY)
+      {
+        slot = (slot + 1) & mask;
+      }
+      tablebase->entries_[slot] = sorted[index];
+    }
+    tablebase->count_ = count;
+    tablebase->max_cards_ = build->max_cards_;
+    *longest = build->distance_;
+  }
+  free(sorted);
+  free(build->entries_);
+  build->entries_ = NULL;
+  return return_value;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Takes back one move from every position of the current layer with all
+/// workers
+///
+/// @param build generation with the current layer
+/// @param workers workers that collect the positions of the next layer
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue expandLayer(TablebaseBuild* build,
+  TablebaseWorker workers[])
+{
+  atomic_store(&build->next_position_, 0);
+  int started = 0;
+  for (; started < build->threads_; started++)
+  {
+    workers[started].build_ = build;
+    workers[started].found_count_ = 0;
+    if (pthread_create(&workers[started].thread_, NULL, tablebaseWorker,
+      &workers[started]) != 0)
+    {
+      break;
+    }
+  }
+  for (int index = 0; index < started; index++)
+  {
+    pthread_join(workers[index].thread_, NULL);
+  }
+  for (int index = started; index < build->threads_; index++)
+  {
+    workers[index].found_count_ = 0;
+  }
+  if (started == 0)
+  {
+    return UNIDENTIFIED_ERROR;
+  }
+  // A failed thread leaves its share to the others
+  if (started < build->threads_ && atomic_load(&build->error_) ==
+    EVERYTHING_OK && atomic_load(&build->next_position_) <
+    build->frontier_count_)
+  {
+    return UNIDENTIFIED_ERROR;
+  }
+  return (ReturnValue) atomic_load(&build->error_);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Expands chunks of the current layer until it is used up
+///
+/// @param argument pointer to the TablebaseWorker
+///
+/// @return NULL
+//
+static void* tablebaseWorker(void* argument)
+{
+  TablebaseWorker* worker = (TablebaseWorker*) argument;
+  TablebaseBuild* build = worker->build_;
+  Board board;
+
+  while (atomic_load_explicit(&build->error_, memory_order_relaxed) ==
+    EVERYTHING_OK)
+  {
+    size_t first = atomic_fetch_add(&build->next_position_, FRONTIER_CHUNK);
+    if (first >= build->frontier_count_)
+    {
+      break;
+    }
+    size_t last = first + FRONTIER_CHUNK < build->frontier_count_ ?
+      first + FRONTIER_CHUNK : build->frontier_count_;
+    for (size_t position = first; position < last; position++)
+    {
+      unpackBoard(&build->frontier_[position], &board);
+      expandBoard(worker, &board);
+    }
+  }
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Records every position one move before a board. These are the moves of
+/// generateMoves taken back: a run put onto a deposit or a game stack
+/// returns to another game stack, a single card may also return to the draw
+/// stack, and NEXT returns the bottom card of the draw stack to the top.
+///
+/// @param worker worker that collects the positions
+/// @param board board of the current layer
+///
+//
+static void expandBoard(TablebaseWorker* worker, const Board* board)
+{
+  int outside = NUMBER_OF_CARDS - board->size_[DEPOSIT_STACK_1] -
+    board->size_[DEPOSIT_STACK_2];
+  Board previous;
+
+  for (int deposit = DEPOSIT_STACK_1; deposit <= DEPOSIT_STACK_2; deposit++)
+  {
+    for (int count = 1; count <= board->size_[deposit] &&
+      outside + count <= worker->build_->max_cards_; count++)
+    {
+      for (int source = 0; source <= NUMBER_OF_GAMESTACKS; source++)
+      {
+        if (source == DRAWSTACK && count > 1)
+        {
+          continue;
+        }
+        previous = *board;
+        moveTop(&previous, deposit, count, source);
+        recordBoard(worker, &previous);
+      }
+    }
+  }
+
+  for (int target = 1; target <= NUMBER_OF_GAMESTACKS; target++)
+  {
+    const signed char* cards = board->cards_[target];
+    int size = board->size_[target];
+    for (int index = size - 1; index >= 0; index--)
+    {
+      if (index < size - 1 && !twoCardsInOrder(cards[index], cards[index + 1],
+        target))
+      {
+        break;
+      }
+      // The stack below the run must have accepted its lowest card
+      if (index == 0 ? cards[0] < BLACK_KING :
+        !twoCardsInOrder(cards[index - 1], cards[index], target))
+      {
+        continue;
+      }
+      for (int source = 0; source <= NUMBER_OF_GAMESTACKS; source++)
+      {
+        if (source == target || (source == DRAWSTACK && index < size - 1))
+        {
+          continue;
+        }
+        previous = *board;
+        moveTop(&previous, target, size - index, source);
+        recordBoard(worker, &previous);
+      }
+    }
+  }
+
+  int size = board->size_[DRAWSTACK];
+  if (size > 1)
+  {
+    previous = *board;
+    memmove(&previous.cards_[DRAWSTACK][0], &previous.cards_[DRAWSTACK][1],
+      size - 1);
+    previous.cards_[DRAWSTACK][size - 1] = board->cards_[DRAWSTACK][0];
+    recordBoard(worker, &previous);
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Moves the top cards of a stack onto another stack in the same order
+///
+/// @param board board to change
+/// @param from stack to take the cards from
+/// @param count number of cards
+/// @param to stack to put the cards onto
+///
+//
+static void moveTop(Board* board, int from, int count, int to)
+{
+  board->size_[from] -= count;
+  memcpy(&board->cards_[to][board->size_[to]],
+    &board->cards_[from][board->size_[from]], count);
+  board->size_[to] += count;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Orders two table entries for qsort
+///
+/// @param first pointer to the first entry
+/// @param second pointer to the second entry
+///
+/// @return negative, zero or positive like strcmp
+//
+static int compareEntries(const void* first, const void* second)
+{
+  unsigned long long left = *(const unsigned long long*) first;
+  unsigned long long right = *(const unsigned long long*) second;
+  return (left > right) - (left < right);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Adds a position to the next layer unless it is already known
+///
+/// @param worker worker that collects the positions
+/// @param board position one move further from the win
+///
+//
+static void recordBoard(TablebaseWorker* worker, const Board* board)
+{
+  TablebaseBuild* build = worker->build_;
+  if (!insertEntry(build, canonicalHash(board), build->distance_ + 1))
+  {
+    return;
+  }
+  if (worker->found_count_ == worker->found_capacity_)
+  {
+    size_t capacity = worker->found_capacity_ == 0 ? INITIAL_FOUND_SIZE :
+      worker->found_capacity_ * TWO;
+    if (!reserveMemory(build, (capacity - worker->found_capacity_) *
+      sizeof(PackedBoard)))
+    {
+      return;
+    }
+    PackedBoard* found = (PackedBoard*) realloc(worker->found_,
+      capacity * sizeof(PackedBoard));
+    if (found == NULL)
+    {
+      atomic_store(&build->error_, OUT_OF_MEMORY);
+      return;
+    }
+    worker->found_ = found;
+    worker->found_capacity_ = capacity;
+  }
+  packBoard(board, &worker->found_[worker->found_count_++]);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Inserts a position unless it is known. Concurrent inserts of the same
+/// position are decided by compare and swap.
+///
+/// @param build generation to insert into
+/// @param key canonical hash of the position
+/// @param distance number of moves to the win
+///
+/// @return true if the position was new
+//
+static bool insertEntry(TablebaseBuild* build, unsigned long long key,
+  int distance)
+{
+  unsigned long long entry = (key & ENTRY_KEY_MASK) |
+    (unsigned long long)(distance + 1);
+  size_t mask = build->capacity_ - 1;
+  for (size_t slot = (key >> ENTRY_DISTANCE_BITS) & mask;;
+    slot = (slot + 1) & mask)
+  {
+    unsigned long long current = atomic_load_explicit(&build->entries_[slot],
+      memory_order_relaxed);
+    if (current == EMPTY_ENTRY && atomic_compare_exchange_strong(
+      &build->entries_[slot], &current, entry))
+    {
+      break;
+    }
+    if ((current & ENTRY_KEY_MASK) == (key & ENTRY_KEY_MASK))
+    {
+      return false;
+    }
+  }
+  if ((atomic_fetch_add(&build->count_, 1) + 1) * 4 > build->capacity_ * 3)
+  {
+    atomic_store(&build->error_, OUT_OF_MEMORY);
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Accounts memory against the budget of the generation
+///
+/// @param build generation to account to
+/// @param bytes number of bytes
+///
+/// @return false if the budget is exceeded, which stops the generation
+//
+static bool reserveMemory(TablebaseBuild* build, size_t bytes)
+{
+  if (atomic_fetch_add(&build->memory_used_, bytes) + bytes >
+    build->memory_limit_)
+  {
+    atomic_store(&build->error_, OUT_OF_MEMORY);
+    return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Returns memory to the budget of the generation
+///
+/// @param build generation to account to
+/// @param bytes number of bytes
+///
+//
+static void releaseMemory(TablebaseBuild* build, size_t bytes)
+{
+  atomic_fetch_sub(&build->memory_used_, bytes);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Appends a value to a packed board
+///
+/// @param packed packed board to extend
+/// @param position pointer to the number of bits written so far
+/// @param value value to write
+/// @param bits number of bits of the value
+///
+//
+static void writeBits(PackedBoard* packed, int* position,
+  unsigned long long value, int bits)
+{
+  int word = *position / PACKED_WORD_BITS;
+  int offset = *position % PACKED_WORD_BITS;
+  packed->bits_[word] |= value << offset;
+  if (offset + bits > PACKED_WORD_BITS)
+  {
+    packed->bits_[word + 1] |= value >> (PACKED_WORD_BITS - offset);
+  }
+  *position += bits;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Reads the next value of a packed board
+///
+/// @param packed packed board to read
+/// @param position pointer to the number of bits read so far
+/// @param bits number of bits of the value
+///
+/// @return the value
+//
+static unsigned long long readBits(const PackedBoard* packed, int* position,
+  int bits)
+{
+  int word = *position / PACKED_WORD_BITS;
+  int offset = *position % PACKED_WORD_BITS;
+  unsigned long long value = packed->bits_[word] >> offset;
+  if (offset + bits > PACKED_WORD_BITS)
+  {
+    value |= packed->bits_[word + 1] << (PACKED_WORD_BITS - offset);
+  }
+  *position += bits;
+  return value & ((1ULL << bits) - 1);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Packs the stacks outside the deposits of a board
+///
+/// @param board board to pack
+/// @param packed packed board to fill
+///
+//
+static void packBoard(const Board* board, PackedBoard* packed)
+{
+  int position = 0;
+  packed->bits_[0] = 0;
+  packed->bits_[1] = 0;
+  for (int stack = 0; stack <= NUMBER_OF_GAMESTACKS; stack++)
+  {
+    writeBits(packed, &position, board->size_[stack], STACK_SIZE_BITS);
+    for (int index = 0; index < board->size_[stack]; index++)
+    {
+      writeBits(packed, &position, (unsigned char)board->cards_[stack][index],
+        CARD_BITS);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Unpacks a board. Every card that is not on stacks 0 to 4 lies on its
+/// deposit, the black cards on the first and the red cards on the second.
+///
+/// @param packed packed board
+/// @param board board to fill
+///
+//
+static void unpackBoard(const PackedBoard* packed, Board* board)
+{
+  bool outside[NUMBER_OF_CARDS] = { false };
+  int position = 0;
+  for (int stack = 0; stack <= NUMBER_OF_GAMESTACKS; stack++)
+  {
+    board->size_[stack] = (unsigned char)readBits(packed, &position,
+      STACK_SIZE_BITS);
+    for (int index = 0; index < board->size_[stack]; index++)
+    {
+      int card = (int)readBits(packed, &position, CARD_BITS);
+      board->cards_[stack][index] = (signed char)card;
+      outside[card] = true;
+    }
+  }
+  for (int face = 0; face < NUMBER_OF_CARDFACES; face++)
+  {
+    int deposit = DEPOSIT_STACK_1 + face;
+    board->size_[deposit] = 0;
+    for (int card = face; card < NUMBER_OF_CARDS && !outside[card];
+      card += TWO)
+    {
+      board->cards_[deposit][board->size_[deposit]++] = (signed char)card;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Builds the board with every card on its deposit
+///
+/// @param board board to fill
+///
+//
+static void wonBoard(Board* board)
+{
+  memset(board, 0, sizeof(Board));
+  for (int card = 0; card < NUMBER_OF_CARDS; card++)
+  {
+    int deposit = DEPOSIT_STACK_1 + card % TWO;
+    board->cards_[deposit][board->size_[deposit]++] = (signed char)card;
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Writes a text header followed by the entries of the table
+///
+/// @param tablebase tablebase to write
+/// @param longest largest distance to the win
+/// @param path path of the file
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue writeTablebase(const Tablebase* tablebase, int longest,
+  const char* path)
+{
+  FILE* file = fopen(path, "wb");
+  if (file == NULL)
+  {
+    return INVALID_FILE;
+  }
+  unsigned long long byte_order = TABLEBASE_BYTE_ORDER;
+  fprintf(file, "%s %d %d %zu %zu %d\n", TABLEBASE_MAGIC, TABLEBASE_VERSION,
+    tablebase->max_cards_, tablebase->capacity_, tablebase->count_, longest);
+  bool written = fwrite(&byte_order, sizeof(byte_order), 1, file) == 1 &&
+    fwrite(tablebase->entries_, sizeof(unsigned long long),
+    tablebase->capacity_, file) == tablebase->capacity_;
+  written = fclose(file) == 0 && written;
+  return written ? EVERYTHING_OK : INVALID_FILE;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Reads a tablebase written by runTablebase. Tables written on a machine
+/// with the other byte order are converted, damaged ones are rejected.
+///
+/// @param tablebase tablebase to fill
+/// @param path path of the file
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue tablebaseLoad(Tablebase* tablebase, const char* path)
+{
+  char magic[sizeof(TABLEBASE_MAGIC)];
+  int version = 0;
+  int longest = 0;
+  unsigned long long byte_order = 0;
+  memset(tablebase, 0, sizeof(Tablebase));
+  FILE* file = fopen(path, "rb");
+  if (file == NULL)
+  {
+    return INVALID_FILE;
+  }
+  if (fscanf(file, "%19s %d %d %zu %zu %d", magic, &version,
+    &tablebase->max_cards_, &tablebase->capacity_, &tablebase->count_,
+    &longest) != 6 || fgetc(file) != '\n' ||
+    strcmp(magic, TABLEBASE_MAGIC) != 0 || version != TABLEBASE_VERSION ||
+    tablebase->max_cards_ < 1 || MAX_TABLEBASE_CARDS < tablebase->max_cards_ ||
+    tablebase->capacity_ == 0 ||
+    (tablebase->capacity_ & (tablebase->capacity_ - 1)) != 0 ||
+    tablebase->count_ >= tablebase->capacity_ ||
+    longest < 0 || MAX_DISTANCE <= longest ||
+    fread(&byte_order, sizeof(byte_order), 1, file) != 1 ||
+    (byte_order != TABLEBASE_BYTE_ORDER &&
+    byte_order != __builtin_bswap64(TABLEBASE_BYTE_ORDER)))
+  {
+    fclose(file);
+    memset(tablebase, 0, sizeof(Tablebase));
+    return INVALID_TABLEBASE;
+  }
+  tablebase->entries_ = (unsigned long long*) malloc(tablebase->capacity_ *
+    sizeof(unsigned long long));
+  if (tablebase->entries_ == NULL)
+  {
+    fclose(file);
+    memset(tablebase, 0, sizeof(Tablebase));
+    return OUT_OF_MEMORY;
+  }
+  size_t read = fread(tablebase->entries_, sizeof(unsigned long long),
+    tablebase->capacity_, file);
+  bool trailing = fgetc(file) != EOF;
+  fclose(file);
+  if (byte_order != TABLEBASE_BYTE_ORDER)
+  {
+    for (size_t index = 0; index < read; index++)
+    {
+      tablebase->entries_[index] =
+        __builtin_bswap64(tablebase->entries_[index]);
+    }
+  }
+  if (read != tablebase->capacity_ || trailing ||
+    checkEntries(tablebase, longest) != EVERYTHING_OK)
+  {
+    tablebaseFree(tablebase);
+    return INVALID_TABLEBASE;
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Checks that the entries match the header. The number of used slots has to
+/// be count_, which leaves an empty slot that ends every probe sequence, and
+/// every distance has to be at most the longest ending.
+///
+/// @param tablebase tablebase with the entries read
+/// @param longest largest distance to the win from the header
+///
+/// @return value to evaluate the occurrence of an error
+//
+static ReturnValue checkEntries(const Tablebase* tablebase, int longest)
+{
+  size_t used = 0;
+  for (size_t index = 0; index < tablebase->capacity_; index++)
+  {
+    unsigned long long entry = tablebase->entries_[index];
+    if (entry == EMPTY_ENTRY)
+    {
+      continue;
+    }
+    int distance = (int)(entry & ENTRY_DISTANCE_MASK) - 1;
+    if (distance < 0 || longest < distance)
+    {
+      return INVALID_TABLEBASE;
+    }
+    used++;
+  }
+  return used == tablebase->count_ ? EVERYTHING_OK : INVALID_TABLEBASE;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Frees the entries of a tablebase
+///
+/// @param tablebase tablebase to free
+///
+//
+void tablebaseFree(Tablebase* tablebase)
+{
+  free(tablebase->entries_);
+  memset(tablebase, 0, sizeof(Tablebase));
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Checks if a board has few enough cards outside the deposits to be in the
+/// tablebase
+///
+/// @param tablebase tablebase to check, may be NULL
+/// @param board board to check
+///
+/// @return boolean data type true or false
+//
+bool tablebaseCovers(const Tablebase* tablebase, const Board* board)
+{
+  return tablebase != NULL && tablebase->entries_ != NULL &&
+    NUMBER_OF_CARDS - board->size_[DEPOSIT_STACK_1] -
+    board->size_[DEPOSIT_STACK_2] <= tablebase->max_cards_;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Looks up a board that is covered by the tablebase
+///
+/// @param tablebase tablebase to search
+/// @param board board to look up
+///
+/// @return number of moves to the win or NOT_WINNABLE
+//
+int tablebaseLookup(const Tablebase* tablebase, const Board* board)
+{
+  unsigned long long key = canonicalHash(board) & ENTRY_KEY_MASK;
+  size_t mask = tablebase->capacity_ - 1;
+  for (size_t slot = (key >> ENTRY_DISTANCE_BITS) & mask;;
+    slot = (slot + 1) & mask)
+  {
+    unsigned long long entry = tablebase->entries_[slot];
+    if (entry == EMPTY_ENTRY)
+    {
+      return NOT_WINNABLE;
+    }
+    if ((entry & ENTRY_KEY_MASK) == key)
+    {
+      return (int)(entry & ENTRY_DISTANCE_MASK) - 1;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Picks the move that gets closest to the win from a covered board
+///
+/// @param tablebase tablebase to search
+/// @param board board to move on
+/// @param moves moves of the board as returned by generateMoves
+/// @param move_count number of moves
+///
+/// @return index of the move whose board is closest to the win, -1 if the
+///         board is won or lost or no move gets closer
+//
+int tablebaseMove(const Tablebase* tablebase, const Board* board,
+  const Move moves[], int move_count)
+{
+  int distance = tablebaseLookup(tablebase, board);
+  int best = -1;
+  for (int index = 0; distance > 0 && index < move_count; index++)
+  {
+    Board child = *board;
+    applyMove(&child, moves[index]);
+    int child_distance = tablebaseLookup(tablebase, &child);
+    if (child_distance != NOT_WINNABLE && child_distance < distance)
+    {
+      // A rotation may skip several single NEXT moves of the table
+      best = index;
+      distance = child_distance;
+    }
+  }
+  return best;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Compares the table with a forward breadth first search over generateMoves
+/// on random positions, so the moves taken back by expandBoard stay the
+/// inverse of the moves the game allows
+///
+/// @param argc number of arguments
+/// @param argv --verify FILE [--positions N] [--seed N]
+///
+/// @return exit code of the program, 1 if a distance differs
+//
+int verifyTablebase(int argc, char* argv[])
+{
+  const char* path = NULL;
+  int positions = DEFAULT_VERIFY_POSITIONS;
+  unsigned long long random = 1;
+  Option known[] = {
+    { "--verify", OPTION_STRING, &path },
+    { "--positions", OPTION_INT, &positions },
+    { "--seed", OPTION_UNSIGNED, &random } };
+  if (parseOptions(argc, argv, 1, known, sizeof(known) / sizeof(known[0])) !=
+    EVERYTHING_OK || path == NULL || positions < 1)
+  {
+    return printErrorMessage(INVALID_ARG_COUNT);
+  }
+  random = random == 0 ? 1 : random;
+
+  Tablebase tablebase;
+  ReturnValue return_value = tablebaseLoad(&tablebase, path);
+  if (return_value != EVERYTHING_OK)
+  {
+    return printErrorMessage(return_value);
+  }
+  VisitedSet visited;
+  Board* queue = (Board*) malloc(VERIFY_QUEUE_SIZE * sizeof(Board));
+  int* distances = (int*) malloc(VERIFY_QUEUE_SIZE * sizeof(int));
+  // Never flushed, the queue overflows first
+  if (queue == NULL || distances == NULL ||
+    visitedInit(&visited, VERIFY_QUEUE_SIZE * TWO) != EVERYTHING_OK)
+  {
+    free(queue);
+    free(distances);
+    tablebaseFree(&tablebase);
+    return printErrorMessage(OUT_OF_MEMORY);
+  }
+
+  int winnable = 0;
+  int lost = 0;
+  int skipped = 0;
+  int mismatches = 0;
+  for (int position = 0; position < positions; position++)
+  {
+    Board board;
+    randomEndgame(&board, tablebase.max_cards_, &random);
+    int expected = forwardDistance(&board, queue, distances, &visited);
+    if (expected < NOT_WINNABLE)
+    {
+      skipped++;
+      continue;
+    }
+    int stored = tablebaseLookup(&tablebase, &board);
+    if (stored != expected && ++mismatches <= MAX_PRINTED_MISMATCHES)
+    {
+      printf("position %d: search %d moves, table %d moves\n", position,
+        expected, stored);
+    }
+    expected == NOT_WINNABLE ? lost++ : winnable++;
+  }
+  printf("verified %d positions: %d winnable, %d lost, %d skipped, "
+    "%d mismatches\n", winnable + lost, winnable, lost, skipped, mismatches);
+  visitedFree(&visited);
+  free(queue);
+  free(distances);
+  tablebaseFree(&tablebase);
+  return mismatches == 0 ? 0 : 1;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Deals a random position with up to max_cards cards outside the deposits.
+/// The highest cards of both colors are spread over the draw stack and the
+/// game stacks in any order, the rest lies on the deposits.
+///
+/// @param board board to fill
+/// @param max_cards largest number of cards outside the deposits
+/// @param random state of the random number generator
+///
+//
+static void randomEndgame(Board* board, int max_cards,
+  unsigned long long* random)
+{
+  int ranks = NUMBER_OF_CARDS / NUMBER_OF_CARDFACES;
+  int outside = 1 + randomNumber(random) % max_cards;
+  int black = randomNumber(random) % (outside + 1);
+  black = black > ranks ? ranks : black;
+  int red = outside - black > ranks ? ranks : outside - black;
+  int cards[NUMBER_OF_CARDS];
+  int count = 0;
+  for (int rank = ranks - black; rank < ranks; rank++)
+  {
+    cards[count++] = rank * TWO;
+  }
+  for (int rank = ranks - red; rank < ranks; rank++)
+  {
+    cards[count++] = rank * TWO + 1;
+  }
+
+  memset(board, 0, sizeof(Board));
+  for (int card = count - 1; card >= 0; card--)
+  {
+    int other = randomNumber(random) % (card + 1);
+    int swap = cards[card];
+    cards[card] = cards[other];
+    cards[other] = swap;
+    int stack = randomNumber(random) % (NUMBER_OF_GAMESTACKS + 1);
+    board->cards_[stack][board->size_[stack]++] = cards[card];
+  }
+  int black_deposit = DEPOSIT_STACK_1 + randomNumber(random) % TWO;
+  int red_deposit = DEPOSIT_STACK_1 + DEPOSIT_STACK_2 - black_deposit;
+  for (int rank = 0; rank < ranks - black; rank++)
+  {
+    board->cards_[black_deposit][board->size_[black_deposit]++] = rank * TWO;
+  }
+  for (int rank = 0; rank < ranks - red; rank++)
+  {
+    board->cards_[red_deposit][board->size_[red_deposit]++] = rank * TWO + 1;
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Finds the shortest distance to the win by a breadth first search over
+/// generateMoves, counting every NEXT like the table does
+///
+/// @param start board to search from
+/// @param queue room for VERIFY_QUEUE_SIZE boards
+/// @param distances room for VERIFY_QUEUE_SIZE distances
+/// @param visited set of at least twice VERIFY_QUEUE_SIZE slots
+///
+/// @return number of moves, NOT_WINNABLE or less if the queue overflowed
+//
+static int forwardDistance(const Board* start, Board queue[], int distances[],
+  VisitedSet* visited)
+{
+  Move moves[MAX_MOVES];
+  int head = 0;
+  int tail = 0;
+  visitedClear(visited);
+  visitedInsert(visited, canonicalHash(start));
+  queue[tail] = *start;
+  distances[tail++] = 0;
+  while (head < tail)
+  {
+    const Board* board = &queue[head];
+    int distance = distances[head++];
+    if (isWon(board))
+    {
+      return distance;
+    }
+    int count = generateMoves(board, moves);
+    for (int move = 0; move < count; move++)
+    {
+      Board child = *board;
+      applyMove(&child, moves[move]);
+      if (!visitedInsert(visited, canonicalHash(&child)))
+      {
+        continue;
+      }
+      if (tail == VERIFY_QUEUE_SIZE)
+      {
+        return NOT_WINNABLE - 1;
+      }
+      queue[tail] = child;
+      distances[tail++] = distance + 1;
+    }
+  }
+  return NOT_WINNABLE;
+}
@@ -0,0 +1,44 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include "solver.h"
+
+#define TABLEBASE_MAGIC "SOLITAIRE-TABLEBASE"
+#define TABLEBASE_VERSION 2
+// Written after the header, a table read with the other byte order sees the
+// bytes reversed
+#define TABLEBASE_BYTE_ORDER 0x0102030405060708ULL
+// Stack sizes are packed into four bits
+#define MAX_TABLEBASE_CARDS 15
+#define DEFAULT_TABLEBASE_MEMORY 1024
+#define NOT_WINNABLE -1
+#define DEFAULT_VERIFY_POSITIONS 2000
+#define VERIFY_QUEUE_SIZE (1 << 16)
+
+// Distances to the win of every winnable position with at most max_cards_
+// cards outside the deposits. Entries hold the upper bits of the canonical
+// hash and the distance plus one in the lowest byte, positions without an
+// entry are lost.
+typedef struct _Tablebase_
+{
+  unsigned long long* entries_;
+  size_t capacity_;
+  size_t count_;
+  int max_cards_;
+} Tablebase;
+
+ReturnValue tablebaseLoad(Tablebase* tablebase, const char* path);
+void tablebaseFree(Tablebase* tablebase);
+bool tablebaseCovers(const Tablebase* tablebase, const Board* board);
+int tablebaseLookup(const Tablebase* tablebase, const Board* board);
+int tablebaseMove(const Tablebase* tablebase, const Board* board,
+  const Move moves[], int move_count);
+int runTablebase(int argc, char* argv[]);
+int verifyTablebase(int argc, char* argv[]);
+
+#endif // TABLEBASE_H
@@ -0,0 +1,347 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+#define NANOSECONDS_PER_MICROSECOND 1000.0
+
+typedef struct _TraceEvent_
+{
+  const char* name_;
+  const char* arg_name_;
+  unsigned long long start_;
+  unsigned long long duration_;
+  long long arg_;
+} TraceEvent;
+
+// Single producer, single consumer ring. Only the owning thread advances
+// head_ and only the trace writer advances tail_, so no lock is needed.
+// released_ is set when the owning thread exits, the writer then frees the
+// ring after draining it and its slot can be taken by a new thread.
+typedef struct _TraceRing_
+{
+  TraceEvent events_[TRACE_RING_SIZE];
+  atomic_ulong head_;
+  atomic_ulong tail_;
+  atomic_ulong dropped_;
+  atomic_bool released_;
+  char name_[TRACE_THREAD_NAME_SIZE];
+  int id_;
+} TraceRing;
+
+atomic_bool trace_enabled = false;
+
+static _Atomic(TraceRing*) trace_rings[MAX_TRACE_THREADS];
+static atomic_int trace_next_id;
+static atomic_ulong trace_untraced_threads;
+static _Thread_local TraceRing* thread_ring;
+static _Thread_local bool thread_untraced;
+static pthread_key_t trace_ring_key;
+static FILE* trace_file;
+static pthread_t trace_writer;
+static atomic_bool trace_writer_running;
+static bool trace_named[MAX_TRACE_THREADS];
+static bool trace_first_event;
+static unsigned long long trace_origin;
+static unsigned long trace_dropped;
+
+static TraceRing* threadRing(const char* name);
+static void releaseRing(void* ring);
+static void* traceWriter(void* argument);
+static void drainRings(void);
+
+//-----------------------------------------------------------------------------
+///
+/// Opens the trace file and starts the thread that drains the per thread
+/// rings into it
+///
+/// @param path file to write the Chrome trace event JSON to
+///
+/// @return value to evaluate the occurrence of an error
+//
+ReturnValue traceStart(const char* path)
+{
+  trace_file = fopen(path, "w");
+  if (trace_file == NULL)
+  {
+    return INVALID_FILE;
+  }
+  fprintf(trace_file, "{\"traceEvents\":[\n");
+  trace_first_event = true;
+  trace_origin = traceNow();
+  trace_dropped = 0;
+  atomic_store(&trace_next_id, 0);
+  atomic_store(&trace_untraced_threads, 0);
+  if (pthread_key_create(&trace_ring_key, releaseRing) != 0)
+  {
+    fclose(trace_file);
+    trace_file = NULL;
+    return UNIDENTIFIED_ERROR;
+  }
+  atomic_store(&trace_writer_running, true);
+  if (pthread_create(&trace_writer, NULL, traceWriter, NULL) != 0)
+  {
+    pthread_key_delete(trace_ring_key);
+    fclose(trace_file);
+    trace_file = NULL;
+    return UNIDENTIFIED_ERROR;
+  }
+  atomic_store(&trace_enabled, true);
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Stops tracing, writes the remaining spans and closes the trace file. All
+/// traced threads except the calling one must have finished.
+///
+//
+void traceStop(void)
+{
+  if (trace_file == NULL)
+  {
+    return;
+  }
+  atomic_store(&trace_enabled, false);
+  atomic_store(&trace_writer_running, false);
+  pthread_join(trace_writer, NULL);
+  drainRings();
+  fprintf(trace_file, "\n]}\n");
+  fclose(trace_file);
+  trace_file = NULL;
+
+  for (int index = 0; index < MAX_TRACE_THREADS; index++)
+  {
+    TraceRing* ring = atomic_load(&trace_rings[index]);
+    if (ring != NULL)
+    {
+      trace_dropped += atomic_load(&ring->dropped_);
+      free(ring);
+    }
+    atomic_store(&trace_rings[index], NULL);
+    trace_named[index] = false;
+  }
+  pthread_setspecific(trace_ring_key, NULL);
+  pthread_key_delete(trace_ring_key);
+  thread_ring = NULL;
+  thread_untraced = false;
+  if (trace_dropped != 0)
+  {
+    printf("[INFO] %lu trace events dropped\n", trace_dropped);
+  }
+  unsigned long untraced = atomic_load(&trace_untraced_threads);
+  if (untraced != 0)
+  {
+    printf("[INFO] %lu threads not traced, more than %d ran at once\n",
+      untraced, MAX_TRACE_THREADS);
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Names the calling thread in the trace. Must be called before the thread
+/// records its first span.
+///
+/// @param name name shown for the thread
+///
+//
+void traceThreadName(const char* name)
+{
+  if (TRACE_ENABLED())
+  {
+    threadRing(name);
+  }
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Reads the monotonic clock
+///
+/// @return nanoseconds
+//
+unsigned long long traceNow(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Records a span that started at start and ends now. A full ring drops the
+/// span instead of waiting for the writer.
+///
+/// @param name name of the span, must be a string literal
+/// @param start value of TRACE_BEGIN at the start of the span
+/// @param arg_name name of the argument or NULL
+/// @param arg argument shown with the span
+///
+//
+void traceSpan(const char* name, unsigned long long start,
+  const char* arg_name, long long arg)
+{
+  TraceRing* ring = threadRing(NULL);
+  if (ring == NULL)
+  {
+    return;
+  }
+  unsigned long head = atomic_load_explicit(&ring->head_, memory_order_relaxed);
+  unsigned long tail = atomic_load_explicit(&ring->tail_, memory_order_acquire);
+  if (head - tail == TRACE_RING_SIZE)
+  {
+    atomic_fetch_add_explicit(&ring->dropped_, 1, memory_order_relaxed);
+    return;
+  }
+  TraceEvent* event = &ring->events_[head % TRACE_RING_SIZE];
+  event->name_ = name;
+  event->arg_name_ = arg_name;
+  event->start_ = start;
+  event->duration_ = traceNow() - start;
+  event->arg_ = arg;
+  atomic_store_explicit(&ring->head_, head + 1, memory_order_release);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Returns the ring of the calling thread and registers a new one in a free
+/// slot on first use. A thread that found no free slot is counted once and
+/// records nothing.
+///
+/// @param name name of the thread or NULL for a numbered name
+///
+/// @return ring of the thread, NULL if no ring is left
+//
+static TraceRing* threadRing(const char* name)
+{
+  if (thread_ring != NULL || thread_untraced)
+  {
+    return thread_ring;
+  }
+  TraceRing* ring = (TraceRing*) calloc(1, sizeof(TraceRing));
+  if (ring == NULL)
+  {
+    return NULL;
+  }
+  ring->id_ = atomic_fetch_add(&trace_next_id, 1) + 1;
+  if (name != NULL)
+  {
+    snprintf(ring->name_, TRACE_THREAD_NAME_SIZE, "%s", name);
+  }
+  else
+  {
+    snprintf(ring->name_, TRACE_THREAD_NAME_SIZE, "thread %d", ring->id_);
+  }
+  for (int index = 0; index < MAX_TRACE_THREADS; index++)
+  {
+    TraceRing* empty = NULL;
+    if (atomic_compare_exchange_strong_explicit(&trace_rings[index], &empty,
+      ring, memory_order_release, memory_order_relaxed))
+    {
+      pthread_setspecific(trace_ring_key, ring);
+      thread_ring = ring;
+      return ring;
+    }
+  }
+  free(ring);
+  thread_untraced = true;
+  atomic_fetch_add(&trace_untraced_threads, 1);
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Hands the ring of an exiting thread back to the writer
+///
+/// @param ring ring of the thread
+///
+//
+static void releaseRing(void* ring)
+{
+  atomic_store_explicit(&((TraceRing*) ring)->released_, true,
+    memory_order_release);
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Drains the rings periodically until tracing stops
+///
+/// @param argument unused
+///
+/// @return NULL
+//
+static void* traceWriter(void* argument)
+{
+  (void)argument;
+  while (atomic_load(&trace_writer_running))
+  {
+    drainRings();
+    usleep(TRACE_DRAIN_MICROSECONDS);
+  }
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Writes all recorded spans as complete events to the trace file
+///
+//
+static void drainRings(void)
+{
+  for (int index = 0; index < MAX_TRACE_THREADS; index++)
+  {
+    TraceRing* ring = atomic_load_explicit(&trace_rings[index],
+      memory_order_acquire);
+    if (ring == NULL)
+    {
+      continue;
+    }
+    // Read before head_, so every span of a released ring gets drained
+    bool released = atomic_load_explicit(&ring->released_,
+      memory_order_acquire);
+    if (!trace_named[index])
+    {
+      fprintf(trace_file, "%s{\"name\":\"thread_name\",\"ph\":\"M\","
+        "\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+        trace_first_event ? "" : ",\n", ring->id_, ring->name_);
+      trace_first_event = false;
+      trace_named[index] = true;
+    }
+
+    unsigned long tail = atomic_load_explicit(&ring->tail_,
+      memory_order_relaxed);
+    unsigned long head = atomic_load_explicit(&ring->head_,
+      memory_order_acquire);
+    for (; tail != head; tail++)
+    {
+      const TraceEvent* event = &ring->events_[tail % TRACE_RING_SIZE];
+      fprintf(trace_file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,"
+        "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f", event->name_, ring->id_,
+        (event->start_ - trace_origin) / NANOSECONDS_PER_MICROSECOND,
+        event->duration_ / NANOSECONDS_PER_MICROSECOND);
+      if (event->arg_name_ != NULL)
+      {
+        fprintf(trace_file, ",\"args\":{\"%s\":%lld}", event->arg_name_,
+          event->arg_);
+      }
+      fprintf(trace_file, "}");
+    }
+    atomic_store_explicit(&ring->tail_, tail, memory_order_release);
+    if (released)
+    {
+      trace_dropped += atomic_load(&ring->dropped_);
+      trace_named[index] = false;
+      atomic_store_explicit(&trace_rings[index], NULL, memory_order_release);
+      free(ring);
+    }
+  }
+}
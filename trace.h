@@ -0,0 +1,50 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "solitaire.h"
+
+// Threads traced at the same time, the ring of a thread is reused after it
+// exited
+#define MAX_TRACE_THREADS 64
+#define TRACE_RING_SIZE 4096
+#define TRACE_DRAIN_MICROSECONDS 20000
+#define TRACE_THREAD_NAME_SIZE 32
+
+// Spans are only recorded while tracing is enabled. The flag is only a hint
+// for the call sites, so it is read relaxed. Building with -DNO_TRACE
+// removes every call site.
+#ifdef NO_TRACE
+#define TRACE_BEGIN() 0ULL
+#define TRACE_END(name, start, arg_name, arg)
+#else
+#define TRACE_ENABLED() \
+  atomic_load_explicit(&trace_enabled, memory_order_relaxed)
+#define TRACE_BEGIN() (TRACE_ENABLED() ? traceNow() : 0ULL)
+#define TRACE_END(name, start, arg_name, arg) \
+  do \
+  { \
+    if (TRACE_ENABLED()) \
+    { \
+      traceSpan(name, start, arg_name, arg); \
+    } \
+  } while (0)
+#endif
+
+extern atomic_bool trace_enabled;
+
+ReturnValue traceStart(const char* path);
+void traceStop(void);
+void traceThreadName(const char* name);
+unsigned long long traceNow(void);
+void traceSpan(const char* name, unsigned long long start,
+  const char* arg_name, long long arg);
+
+#endif // TRACE_H
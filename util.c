@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+
+//-----------------------------------------------------------------------------
+///
+/// Reads the options of a command line. Every option but a flag is followed
+/// by its value, numbers are converted with strtol and its siblings. The
+/// caller checks the ranges of the values afterwards.
+///
+/// @param argc number of arguments
+/// @param argv program arguments
+/// @param first index of the first option, the arguments before it are
+///              positional
+/// @param options known options
+/// @param count number of known options
+///
+/// @return INVALID_ARG_COUNT for an unknown option or a missing value
+//
+ReturnValue parseOptions(int argc, char* argv[], int first,
+  const Option options[], int count)
+{
+  for (int index = first; index < argc; index++)
+  {
+    const Option* option = NULL;
+    for (int known = 0; known < count && option == NULL; known++)
+    {
+      if (strcmp(argv[index], options[known].name_) == 0)
+      {
+        option = &options[known];
+      }
+    }
+    if (option == NULL)
+    {
+      return INVALID_ARG_COUNT;
+    }
+    if (option->type_ == OPTION_FLAG)
+    {
+      *(bool*)option->value_ = true;
+      continue;
+    }
+    if (index + 1 >= argc)
+    {
+      return INVALID_ARG_COUNT;
+    }
+
+    char* value = argv[++index];
+    switch (option->type_)
+    {
+    case OPTION_STRING:
+      *(const char**)option->value_ = value;
+      break;
+    case OPTION_INT:
+      *(int*)option->value_ = strtol(value, NULL, 10);
+      break;
+    case OPTION_LONG:
+      *(long*)option->value_ = strtol(value, NULL, 10);
+      break;
+    case OPTION_LONG_LONG:
+      *(long long*)option->value_ = strtoll(value, NULL, 10);
+      break;
+    case OPTION_UNSIGNED:
+      *(unsigned long long*)option->value_ = strtoull(value, NULL, 10);
+      break;
+    case OPTION_FLAG:
+      //left blank intentionally
+      break;
+    }
+  }
+  return EVERYTHING_OK;
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Name of the rank of a card as it is typed and printed
+///
+/// @param card integer value of a card
+///
+/// @return "A" to "K"
+//
+const char* rankName(int card)
+{
+  static const char* const ranks[NUMBER_OF_RANKS] = { "A", "2", "3", "4",
+    "5", "6", "7", "8", "9", "10", "J", "Q", "K" };
+  return ranks[card / TWO];
+}
+
+//-----------------------------------------------------------------------------
+///
+/// Measures the time since start
+///
+/// @param start monotonic start time
+///
+/// @return elapsed seconds
+//
+double secondsSince(const struct timespec* start)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
@@ -0,0 +1,42 @@
+//------------------------------------------------------------------------------
+// Authors: Paul Kodolitsch
+//          Martin Piberger
+//------------------------------------------------------------------------------
+//
+// Helpers shared by the game, the command line tools and the harnesses
+//
+#ifndef UTIL_H
+#define UTIL_H
+
+#include <time.h>
+
+#include "solitaire.h"
+
+#define NUMBER_OF_RANKS 13
+
+// Kind of value an option takes, OPTION_FLAG stands alone and sets a bool
+typedef enum _OptionType_
+{
+  OPTION_FLAG,
+  OPTION_STRING,
+  OPTION_INT,
+  OPTION_LONG,
+  OPTION_LONG_LONG,
+  OPTION_UNSIGNED
+} OptionType;
+
+// Command line option, value_ points to a bool, const char*, int, long,
+// long long or unsigned long long depending on type_
+typedef struct _Option_
+{
+  const char* name_;
+  OptionType type_;
+  void* value_;
+} Option;
+
+ReturnValue parseOptions(int argc, char* argv[], int first,
+  const Option options[], int count);
+const char* rankName(int card);
+double secondsSince(const struct timespec* start);
+
+#endif // UTIL_H